@@ -5,6 +5,7 @@ import android.content.Context
 import android.graphics.SurfaceTexture
 import android.hardware.camera2.CameraCaptureSession
 import android.hardware.camera2.CameraCharacteristics
+import android.hardware.camera2.CameraConstrainedHighSpeedCaptureSession
 import android.hardware.camera2.CameraDevice
 import android.hardware.camera2.CameraManager
 import android.hardware.camera2.CameraMetadata
@@ -29,6 +30,31 @@ data class StreamConfig(
     var bitrate: Int = 1_000_000
 )
 
+// Frame rates the camera can stream, highest first. Rates above the regular AE ranges
+// need a constrained high-speed session.
+fun supportedFrameRates(chars: CameraCharacteristics): List<Int> {
+    val aeRanges = chars.get(CameraCharacteristics.CONTROL_AE_AVAILABLE_TARGET_FPS_RANGES) ?: emptyArray()
+    val map = chars.get(CameraCharacteristics.SCALER_STREAM_CONFIGURATION_MAP)
+    val highSpeed = map?.highSpeedVideoFpsRanges ?: emptyArray()
+    return (aeRanges.map { it.upper } + highSpeed.map { it.upper }).distinct().sortedDescending()
+}
+
+// Highest rate a regular (non high-speed) session can stream
+fun regularMaxFrameRate(chars: CameraCharacteristics): Int =
+    chars.get(CameraCharacteristics.CONTROL_AE_AVAILABLE_TARGET_FPS_RANGES)?.maxOfOrNull { it.upper } ?: 30
+
+// High-speed rates per output size; a rate above the regular maximum only works at these sizes
+fun highSpeedFrameRates(chars: CameraCharacteristics): Map<Size, List<Int>> {
+    val map = chars.get(CameraCharacteristics.SCALER_STREAM_CONFIGURATION_MAP) ?: return emptyMap()
+    return map.highSpeedVideoSizes.associateWith { size ->
+        try {
+            map.getHighSpeedVideoFpsRangesFor(size).map { it.upper }.distinct().sortedDescending()
+        } catch (_: IllegalArgumentException) {
+            emptyList()
+        }
+    }.filterValues { it.isNotEmpty() }
+}
+
 // Data class to hold manual camera settings
 data class ManualControls(
     var iso: Int = 0,             // 0 = Auto
@@ -51,6 +77,7 @@ class CameraStreamer(
     private var backgroundHandler: Handler? = null
     private val outputStream = DataOutputStream(socket.getOutputStream())
     private var codecSurface: android.view.Surface? = null
+    private var highSpeedRange: Range<Int>? = null
 
     private var startTimestampUs: Long = -1
 
@@ -81,6 +108,20 @@ class CameraStreamer(
                 config.width = bestSize.width
                 config.height = bestSize.height
             }
+
+            // 2. FPS Check - rates above the regular AE ranges need a high-speed session at this size
+            highSpeedRange = null
+            val regularMax = regularMaxFrameRate(chars)
+            if (config.fps > regularMax) {
+                val ranges = try {
+                    map?.getHighSpeedVideoFpsRangesFor(Size(config.width, config.height)) ?: emptyArray()
+                } catch (_: IllegalArgumentException) {
+                    emptyArray()
+                }
+                // Prefer a fixed range so the encoder sees a steady cadence
+                highSpeedRange = ranges.filter { it.upper == config.fps }.maxByOrNull { it.lower }
+                if (highSpeedRange == null) config.fps = regularMax
+            }
         } catch (e: Exception) {
             android.util.Log.e("OCam", "Validation failed: ${e.message}")
         }
@@ -193,6 +234,11 @@ class CameraStreamer(
         format.setInteger(MediaFormat.KEY_BIT_RATE, config.bitrate)
         format.setInteger(MediaFormat.KEY_FRAME_RATE, config.fps)
         format.setInteger(MediaFormat.KEY_I_FRAME_INTERVAL, 1)
+        if (config.fps > 60) {
+            // Ask the encoder to run at the capture rate in real time
+            format.setInteger(MediaFormat.KEY_OPERATING_RATE, config.fps)
+            format.setInteger(MediaFormat.KEY_PRIORITY, 0)
+        }
         // Set VBR mode for better stability on older Qualcomm chips
         format.setInteger(MediaFormat.KEY_BITRATE_MODE, MediaCodecInfo.EncoderCapabilities.BITRATE_MODE_VBR)
 
@@ -241,17 +287,20 @@ class CameraStreamer(
             val surface = codecSurface ?: return
             mediaCodec!!.start()
 
-            cachedBuilder = cameraDevice!!.createCaptureRequest(CameraDevice.TEMPLATE_PREVIEW)
+            val highSpeed = highSpeedRange != null
+            cachedBuilder = cameraDevice!!.createCaptureRequest(
+                if (highSpeed) CameraDevice.TEMPLATE_RECORD else CameraDevice.TEMPLATE_PREVIEW
+            )
             cachedBuilder!!.addTarget(surface)
 
             // Apply initial manual controls
             applyManualsToBuilder(cachedBuilder!!)
 
-            cameraDevice!!.createCaptureSession(listOf(surface), object : CameraCaptureSession.StateCallback() {
+            val callback = object : CameraCaptureSession.StateCallback() {
                 override fun onConfigured(session: CameraCaptureSession) {
                     captureSession = session
                     try {
-                        session.setRepeatingRequest(cachedBuilder!!.build(), null, backgroundHandler)
+                        setRepeating(session)
                     } catch (e: Exception) {
                         e.printStackTrace()
                     }
@@ -260,25 +309,41 @@ class CameraStreamer(
                 override fun onConfigureFailed(session: CameraCaptureSession) {
                     stop()
                 }
-            }, backgroundHandler)
+            }
+
+            if (highSpeed) {
+                cameraDevice!!.createConstrainedHighSpeedCaptureSession(listOf(surface), callback, backgroundHandler)
+            } else {
+                cameraDevice!!.createCaptureSession(listOf(surface), callback, backgroundHandler)
+            }
         } catch (e: Exception) {
             e.printStackTrace()
             stop()
         }
     }
 
+    // High-speed sessions only take bursts built by the session itself
+    private fun setRepeating(session: CameraCaptureSession) {
+        val request = cachedBuilder!!.build()
+        if (session is CameraConstrainedHighSpeedCaptureSession) {
+            session.setRepeatingBurst(session.createHighSpeedRequestList(request), null, backgroundHandler)
+        } else {
+            session.setRepeatingRequest(request, null, backgroundHandler)
+        }
+    }
+
     private fun refreshSession() {
         if (captureSession == null || cachedBuilder == null) return
         try {
             applyManualsToBuilder(cachedBuilder!!)
-            captureSession!!.setRepeatingRequest(cachedBuilder!!.build(), null, backgroundHandler)
+            setRepeating(captureSession!!)
         } catch (e: Exception) {
             e.printStackTrace()
         }
     }
 
     private fun applyManualsToBuilder(builder: CaptureRequest.Builder) {
-        builder.set(CaptureRequest.CONTROL_AE_TARGET_FPS_RANGE, Range(config.fps, config.fps))
+        builder.set(CaptureRequest.CONTROL_AE_TARGET_FPS_RANGE, highSpeedRange ?: Range(config.fps, config.fps))
         
         if (manual.iso <= 0 && manual.exposureUs <= 0) {
             builder.set(CaptureRequest.CONTROL_AE_MODE, CameraMetadata.CONTROL_AE_MODE_ON)
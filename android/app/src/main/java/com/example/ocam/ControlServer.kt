@@ -94,10 +94,15 @@ class ControlServer(
         val expRange = chars.get(CameraCharacteristics.SENSOR_INFO_EXPOSURE_TIME_RANGE)
         val minFocus = chars.get(CameraCharacteristics.LENS_INFO_MINIMUM_FOCUS_DISTANCE) ?: 0f
         val flashAvail = chars.get(CameraCharacteristics.FLASH_INFO_AVAILABLE) ?: false
+        val fpsList = supportedFrameRates(chars)
+        val regularMax = regularMaxFrameRate(chars)
+        val highSpeed = highSpeedFrameRates(chars).entries.take(255)
 
         val resPayloadSize = 1 + (sizes.size * 8)
         val extraPayloadSize = 4+4 + 4+4 + 4 + 1
-        val totalSize = resPayloadSize + extraPayloadSize
+        val fpsPayloadSize = 1 + (fpsList.size * 4)
+        val highSpeedPayloadSize = 4 + 1 + highSpeed.sumOf { 4+4 + 1 + it.value.size * 4 }
+        val totalSize = resPayloadSize + extraPayloadSize + fpsPayloadSize + highSpeedPayloadSize
 
         output.writeByte(0x10)
         output.writeInt(totalSize)
@@ -115,6 +120,23 @@ class ControlServer(
         output.writeFloat(minFocus)
         output.writeByte(if (flashAvail) 1 else 0)
 
+        output.writeByte(fpsList.size)
+        for (fps in fpsList) {
+            output.writeInt(fps)
+        }
+
+        // Rates above regularMax need a high-speed session, which only these sizes support
+        output.writeInt(regularMax)
+        output.writeByte(highSpeed.size)
+        for ((size, rates) in highSpeed) {
+            output.writeInt(size.width)
+            output.writeInt(size.height)
+            output.writeByte(rates.size)
+            for (fps in rates) {
+                output.writeInt(fps)
+            }
+        }
+
         output.flush()
     }
 }
\ No newline at end of file
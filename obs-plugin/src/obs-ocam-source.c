@@ -1,3 +1,7 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE // pthread_setaffinity_np, RUSAGE_THREAD
+#endif
+
 #include <obs-module.h>
 #include <util/platform.h>
 #include <util/threading.h>
@@ -26,6 +30,11 @@
     #include <arpa/inet.h>
     #include <unistd.h>
     #include <netdb.h>
+    #include <sys/resource.h>
+    #ifdef __linux__
+        #include <sched.h>
+        #include <sys/syscall.h>
+    #endif
 
     #define CLOSESOCKET close
     #define SHUTDOWN_FLAGS SHUT_RDWR
@@ -71,13 +80,888 @@ static float befloattoh(uint32_t val) {
     return f;
 }
 
+/* --- Thread Policy --- */
+// Every plugin thread registers with its pipeline stage. Registering names the
+// thread, raises (or for background work lowers) its priority where the OS allows
+// it, and pins it to the stage's configured cores. Each thread also samples its
+// own CPU time and involuntary context switches for the properties and the log.
+
+#define THREAD_SAMPLE_NS 2000000000ULL
+#define THREAD_SAMPLE_LOG_WINDOWS 15
+
+enum thread_stage {
+    STAGE_INGEST,
+    STAGE_DECODE,
+    STAGE_PRESENT,
+    STAGE_AUDIO,
+    STAGE_CONTROL,
+    STAGE_BACKGROUND,
+    STAGE_COUNT
+};
+
+static const char *thread_stage_names[STAGE_COUNT] = {"Ingest", "Decode", "Present", "Audio", "Control", "Background"};
+// Settings key of each stage's core list; stages without one run on any core
+static const char *thread_stage_core_keys[STAGE_COUNT] = {"ingest_cores", "decode_cores", NULL, "audio_cores", NULL, NULL};
+
+struct thread_slot {
+    struct thread_slot *next;     // thread_policy.threads
+    enum thread_stage stage;
+    char name[16];
+    long generation;          // thread_policy.generation last applied
+    bool pinned;              // Moved off the inherited affinity
+
+    // Owned by the thread
+    uint64_t sample_ns;
+    uint64_t cpu_ns;
+    int64_t ivcsw;
+    uint32_t samples;
+
+    // Published (thread_policy.mutex)
+    double cpu_pct;           // Over the last sample window
+    double ivcsw_per_sec;     // -1 where the OS does not count them
+    uint64_t published_ns;
+};
+
+static struct {
+    pthread_mutex_t mutex;
+    bool configured;                     // A source has applied its settings
+    bool elevate;                        // Raise latency-critical stages
+    char core_lists[STAGE_COUNT][64];    // As entered, e.g. "2,3" or "4-7"
+    uint64_t cores[STAGE_COUNT];         // Affinity mask per stage, 0 = any core
+#ifdef _WIN32
+    DWORD_PTR inherited;                 // Affinity OBS was started with
+#elif defined(__linux__)
+    cpu_set_t inherited;                 // Affinity OBS was started with (taskset, cpuset)
+#endif
+    bool priority_denied[STAGE_COUNT];   // The OS refused a raise (logged once)
+    int base_nice;                       // Process nice value at load (Linux)
+    volatile long generation;
+    struct thread_slot *threads;         // Every registered thread, however many sources run
+} thread_policy;
+
+// Priority step per stage: audio above the video path, background work below normal
+static int thread_stage_boost(enum thread_stage stage) {
+    switch (stage) {
+    case STAGE_AUDIO: return 2;
+    case STAGE_INGEST:
+    case STAGE_DECODE:
+    case STAGE_PRESENT: return 1;
+    case STAGE_BACKGROUND: return -1;
+    default: return 0;
+    }
+}
+
+enum thread_priority_result {
+    PRIORITY_SET,
+    PRIORITY_DENIED,
+    PRIORITY_UNSUPPORTED,
+};
+
+static enum thread_priority_result thread_set_priority(int boost) {
+#ifdef _WIN32
+    int prio = boost >= 2 ? THREAD_PRIORITY_HIGHEST : boost == 1 ? THREAD_PRIORITY_ABOVE_NORMAL
+             : boost < 0 ? THREAD_PRIORITY_BELOW_NORMAL : THREAD_PRIORITY_NORMAL;
+    return SetThreadPriority(GetCurrentThread(), prio) ? PRIORITY_SET : PRIORITY_DENIED;
+#elif defined(__linux__)
+    // Linux threads have their own nice value, set relative to the process; raising it needs CAP_SYS_NICE or RLIMIT_NICE
+    return setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), thread_policy.base_nice - 5 * boost) == 0 ? PRIORITY_SET : PRIORITY_DENIED;
+#else
+    UNUSED_PARAMETER(boost);
+    return PRIORITY_UNSUPPORTED;
+#endif
+}
+
+// Records the nice value and affinity OBS started with. Called from obs_module_load,
+// before any plugin thread exists.
+static void thread_policy_snapshot(void) {
+#if defined(__linux__)
+    errno = 0;
+    int nice_value = getpriority(PRIO_PROCESS, (id_t)getpid());
+    thread_policy.base_nice = errno ? 0 : nice_value;
+#endif
+
+#ifdef _WIN32
+    DWORD_PTR system_mask = 0;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &thread_policy.inherited, &system_mask)) thread_policy.inherited = (DWORD_PTR)-1;
+#elif defined(__linux__)
+    if (sched_getaffinity(0, sizeof(thread_policy.inherited), &thread_policy.inherited) != 0) {
+        CPU_ZERO(&thread_policy.inherited);
+        for (int i = 0; i < CPU_SETSIZE; i++) CPU_SET(i, &thread_policy.inherited);
+    }
+#endif
+}
+
+// The configured cores OBS may actually run on; 0 if none of them
+static uint64_t thread_affinity_available(uint64_t mask) {
+#ifdef _WIN32
+    return mask & (uint64_t)thread_policy.inherited;
+#elif defined(__linux__)
+    uint64_t available = 0;
+    for (int i = 0; i < 64 && i < CPU_SETSIZE; i++)
+        if ((mask >> i) & 1 && CPU_ISSET(i, &thread_policy.inherited)) available |= 1ULL << i;
+    return available;
+#else
+    return mask;
+#endif
+}
+
+// Pins the calling thread to mask, or returns it to the inherited affinity for 0
+static void thread_set_affinity(uint64_t mask) {
+#ifdef _WIN32
+    SetThreadAffinityMask(GetCurrentThread(), mask ? (DWORD_PTR)mask : thread_policy.inherited);
+#elif defined(__linux__)
+    cpu_set_t set = thread_policy.inherited;
+    if (mask) {
+        CPU_ZERO(&set);
+        for (int i = 0; i < 64 && i < CPU_SETSIZE; i++)
+            if ((mask >> i) & 1) CPU_SET(i, &set);
+    }
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    UNUSED_PARAMETER(mask);
+#endif
+}
+
+// CPU time of the calling thread; involuntary switches are -1 where the OS does not count them
+static void thread_usage(uint64_t *cpu_ns, int64_t *ivcsw) {
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    *cpu_ns = 0;
+    if (GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel, &user)) {
+        uint64_t k = ((uint64_t)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+        uint64_t u = ((uint64_t)user.dwHighDateTime << 32) | user.dwLowDateTime;
+        *cpu_ns = (k + u) * 100;
+    }
+    *ivcsw = -1;
+#elif defined(__linux__)
+    struct rusage ru;
+    if (getrusage(RUSAGE_THREAD, &ru) != 0) memset(&ru, 0, sizeof(ru));
+    *cpu_ns = (uint64_t)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000000ULL +
+              (uint64_t)(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1000ULL;
+    *ivcsw = ru.ru_nivcsw;
+#else
+    *cpu_ns = 0;
+    *ivcsw = -1;
+#endif
+}
+
+// Parses a core list such as "2,3" or "4-7"; 0 (any core) if empty or invalid
+static uint64_t parse_core_list(const char *list) {
+    uint64_t mask = 0;
+    const char *p = list;
+    while (p && *p) {
+        char *end;
+        long first = strtol(p, &end, 10);
+        if (end == p) return 0;
+        long last = first;
+        if (*end == '-') {
+            p = end + 1;
+            last = strtol(p, &end, 10);
+            if (end == p) return 0;
+        }
+        if (first < 0 || last < first || last >= 64) return 0;
+        for (long i = first; i <= last; i++) mask |= 1ULL << i;
+        while (*end == ' ' || *end == ',') end++;
+        p = end;
+    }
+    return mask;
+}
+
+// The policy is process-wide, so the last source to change it wins
+static void thread_policy_update(obs_data_t *settings) {
+    bool elevate = obs_data_get_bool(settings, "thread_priority");
+
+    pthread_mutex_lock(&thread_policy.mutex);
+    bool changed = !thread_policy.configured || elevate != thread_policy.elevate;
+    thread_policy.configured = true;
+    thread_policy.elevate = elevate;
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        if (!thread_stage_core_keys[i]) continue;
+        const char *list = obs_data_get_string(settings, thread_stage_core_keys[i]);
+        uint64_t mask = parse_core_list(list);
+        if (*list && !mask) blog(LOG_WARNING, "[OCAM] Ignoring invalid %s core list '%s'", thread_stage_names[i], list);
+        if (mask && !thread_affinity_available(mask))
+            blog(LOG_WARNING, "[OCAM] None of the %s cores '%s' are available to OBS; ignoring them", thread_stage_names[i], list);
+        mask = thread_affinity_available(mask);
+        changed = changed || mask != thread_policy.cores[i];
+        snprintf(thread_policy.core_lists[i], sizeof(thread_policy.core_lists[i]), "%s", list);
+        thread_policy.cores[i] = mask;
+    }
+    if (changed)
+        blog(LOG_INFO, "[OCAM] Thread policy: priority %s, ingest cores '%s', decode cores '%s', audio cores '%s'",
+             elevate ? "raised" : "normal", thread_policy.core_lists[STAGE_INGEST], thread_policy.core_lists[STAGE_DECODE],
+             thread_policy.core_lists[STAGE_AUDIO]);
+    pthread_mutex_unlock(&thread_policy.mutex);
+
+    if (changed) os_atomic_inc_long(&thread_policy.generation);
+}
+
+// A new source starts from the policy already in effect instead of resetting it to the defaults
+static void thread_policy_fill_settings(obs_data_t *settings) {
+    pthread_mutex_lock(&thread_policy.mutex);
+    if (thread_policy.configured) {
+        if (!obs_data_has_user_value(settings, "thread_priority")) obs_data_set_bool(settings, "thread_priority", thread_policy.elevate);
+        for (int i = 0; i < STAGE_COUNT; i++) {
+            const char *key = thread_stage_core_keys[i];
+            if (key && !obs_data_has_user_value(settings, key)) obs_data_set_string(settings, key, thread_policy.core_lists[i]);
+        }
+    }
+    pthread_mutex_unlock(&thread_policy.mutex);
+}
+
+// (Re)applies priority and affinity for the calling thread
+static void thread_policy_apply(struct thread_slot *slot) {
+    pthread_mutex_lock(&thread_policy.mutex);
+    slot->generation = os_atomic_load_long(&thread_policy.generation);
+    int boost = thread_stage_boost(slot->stage);
+    if (!thread_policy.elevate && boost > 0) boost = 0;
+    uint64_t mask = thread_policy.cores[slot->stage];
+    bool report = false;
+    // Platforms without a priority implementation just keep the default, without a warning
+    if (thread_set_priority(boost) == PRIORITY_DENIED && boost > 0 && !thread_policy.priority_denied[slot->stage]) {
+        thread_policy.priority_denied[slot->stage] = true;
+        report = true;
+    }
+    pthread_mutex_unlock(&thread_policy.mutex);
+
+    // Leave the inherited affinity alone until a core list asks for something else
+    if (mask || slot->pinned) {
+        thread_set_affinity(mask);
+        slot->pinned = mask != 0;
+    }
+    if (report) blog(LOG_WARNING, "[OCAM] Not allowed to raise %s thread priority; running at normal priority", thread_stage_names[slot->stage]);
+}
+
+static struct thread_slot *thread_policy_enter(enum thread_stage stage, const char *name) {
+    os_set_thread_name(name);
+
+    struct thread_slot *slot = bzalloc(sizeof(struct thread_slot));
+    slot->stage = stage;
+    snprintf(slot->name, sizeof(slot->name), "%s", name);
+
+    pthread_mutex_lock(&thread_policy.mutex);
+    slot->next = thread_policy.threads;
+    thread_policy.threads = slot;
+    pthread_mutex_unlock(&thread_policy.mutex);
+
+    thread_policy_apply(slot);
+    slot->sample_ns = os_gettime_ns();
+    thread_usage(&slot->cpu_ns, &slot->ivcsw);
+    return slot;
+}
+
+// Called from the thread's loop: picks up policy changes and samples usage every few seconds
+static void thread_policy_tick(struct thread_slot *slot) {
+    if (os_atomic_load_long(&thread_policy.generation) != slot->generation) thread_policy_apply(slot);
+
+    uint64_t now = os_gettime_ns();
+    if (now - slot->sample_ns < THREAD_SAMPLE_NS) return;
+
+    uint64_t cpu_ns;
+    int64_t ivcsw;
+    thread_usage(&cpu_ns, &ivcsw);
+    double elapsed = (double)(now - slot->sample_ns);
+
+    pthread_mutex_lock(&thread_policy.mutex);
+    slot->cpu_pct = (cpu_ns - slot->cpu_ns) * 100.0 / elapsed;
+    slot->ivcsw_per_sec = ivcsw < 0 ? -1.0 : (ivcsw - slot->ivcsw) * 1e9 / elapsed;
+    slot->published_ns = now;
+    pthread_mutex_unlock(&thread_policy.mutex);
+
+    if (++slot->samples % THREAD_SAMPLE_LOG_WINDOWS == 0 && slot->stage != STAGE_DECODE) {
+        blog(LOG_INFO, "[OCAM] Thread %s: CPU %.1f%%, %.1f involuntary switches/s", slot->name, slot->cpu_pct, slot->ivcsw_per_sec);
+    }
+    slot->sample_ns = now;
+    slot->cpu_ns = cpu_ns;
+    slot->ivcsw = ivcsw;
+}
+
+static void thread_policy_exit(struct thread_slot *slot) {
+    uint64_t cpu_ns;
+    int64_t ivcsw;
+    thread_usage(&cpu_ns, &ivcsw);
+    blog(LOG_INFO, "[OCAM] Thread %s exiting: CPU %.0f ms, %lld involuntary switches", slot->name, cpu_ns / 1e6, (long long)ivcsw);
+
+    pthread_mutex_lock(&thread_policy.mutex);
+    for (struct thread_slot **it = &thread_policy.threads; *it; it = &(*it)->next) {
+        if (*it == slot) { *it = slot->next; break; }
+    }
+    pthread_mutex_unlock(&thread_policy.mutex);
+    bfree(slot);
+}
+
+// One line per active stage for the properties
+static void thread_policy_describe(struct dstr *info) {
+    double cpu[STAGE_COUNT] = {0}, ivcsw[STAGE_COUNT] = {0};
+    int threads[STAGE_COUNT] = {0};
+    bool counted = true;
+    uint64_t now = os_gettime_ns();
+
+    pthread_mutex_lock(&thread_policy.mutex);
+    for (const struct thread_slot *slot = thread_policy.threads; slot; slot = slot->next) {
+        if (!slot->published_ns || now - slot->published_ns > 2 * THREAD_SAMPLE_NS) continue;
+        threads[slot->stage]++;
+        cpu[slot->stage] += slot->cpu_pct;
+        if (slot->ivcsw_per_sec < 0) counted = false;
+        else ivcsw[slot->stage] += slot->ivcsw_per_sec;
+    }
+    bool elevate = thread_policy.elevate;
+    pthread_mutex_unlock(&thread_policy.mutex);
+
+    dstr_printf(info, "Threads (priority %s):", elevate ? "raised" : "normal");
+    bool any = false;
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        if (!threads[i]) continue;
+        dstr_catf(info, "%s %s x%d %.1f%% CPU", any ? "," : "", thread_stage_names[i], threads[i], cpu[i]);
+        if (counted) dstr_catf(info, " %.1f inv. sw/s", ivcsw[i]);
+        any = true;
+    }
+    if (!any) dstr_cat(info, " idle");
+}
+
+/* --- Shared Decode Pool --- */
+// One set of decode workers serves every phone. Each device owns a serial
+// decode queue that at most one worker runs at a time, which keeps its packets in
+// order. Runnable queues sit on per-worker run lists by priority; idle workers
+// take from their own list first and steal from the others.
+
+#define DECODE_POOL_MAX_WORKERS 32
+#define DECODE_QUEUE_MAX_PICTURES 4
+#define DECODE_BATCH 8
+#define DECODE_STATS_WINDOW_NS 2000000000ULL
+#define DECODE_STATS_LOG_WINDOWS 15
+
+enum decode_priority {
+    DECODE_PRIORITY_HIGH,
+    DECODE_PRIORITY_NORMAL,
+    DECODE_PRIORITY_COUNT
+};
+
+enum decode_job_type {
+    DECODE_JOB_RESET,   // Connection opened/closed: drop decoder state
+    DECODE_JOB_CONFIG,  // Codec config packet (pts 0)
+    DECODE_JOB_FRAME,   // Whole access unit
+    DECODE_JOB_SLICE,   // One NAL unit of an access unit (slice decoding)
+    DECODE_JOB_PAUSE,   // No subscriber is visible: stop decoding, keep caching
+    DECODE_JOB_RESUME,  // A subscriber became visible: catch up from the GOP cache
+};
+
+struct decode_job {
+    struct decode_job *next;
+    enum decode_job_type type;
+    AVPacket *packet;
+    int64_t pts_ns;
+    bool chunked;        // Slice decoding was on when the job was queued
+    bool first_slice;
+    bool last_slice;
+    uint64_t recv_start_ns;
+    uint64_t recv_end_ns;
+    uint64_t submit_ns;
+};
+
+struct decode_queue_stats {
+    double fps;
+    double delay_avg_ms;
+    double delay_max_ms;
+    double busy_pct;
+    int depth_max;
+    uint64_t published_ns;
+};
+
+struct decode_queue {
+    pthread_mutex_t mutex;
+    pthread_cond_t drained;      // The queue went idle
+    struct decode_job *head;
+    struct decode_job *tail;
+    int depth;
+    int pictures;                // Queued jobs that complete a picture
+    bool scheduled;              // On a run list or being run by a worker
+    volatile long priority;      // enum decode_priority
+    int home;                    // Worker that ran it last
+    struct decode_queue *run_next;
+    struct decode_queue *registry_next;
+    struct decode_job *free_jobs;     // Recycled jobs, each with an empty packet
+
+    // Returns the number of pictures output for the job
+    int (*process)(void *data, struct decode_job *job);
+    void *data;
+    const char *name;            // For the log
+
+    // Window counters, owned by the running worker
+    uint64_t window_start_ns;
+    uint32_t window_jobs;
+    uint32_t window_frames;
+    uint64_t window_delay_ns;
+    uint64_t window_delay_max_ns;
+    uint64_t window_busy_ns;
+    int window_depth_max;
+    uint32_t windows_published;
+
+    struct decode_queue_stats stats;  // Last published window (mutex)
+};
+
+struct decode_worker {
+    pthread_t thread;
+    bool thread_active;
+    int index;
+    pthread_mutex_t mutex;
+    struct decode_queue *run_head[DECODE_PRIORITY_COUNT];
+    struct decode_queue *run_tail[DECODE_PRIORITY_COUNT];
+};
+
+static struct {
+    pthread_mutex_t mutex;       // refs, registry
+    long refs;
+    volatile bool running;
+    os_sem_t *work;              // One post per run list push
+    int worker_count;
+    struct decode_worker workers[DECODE_POOL_MAX_WORKERS];
+    struct decode_queue *registry;
+    int registered;
+    long next_home;
+} decode_pool;
+
+static void decode_job_free(struct decode_job *job) {
+    if (job->packet) av_packet_free(&job->packet);
+    bfree(job);
+}
+
+static void run_list_push(struct decode_worker *w, struct decode_queue *q) {
+    int prio = (int)os_atomic_load_long(&q->priority);
+    pthread_mutex_lock(&w->mutex);
+    q->run_next = NULL;
+    if (w->run_tail[prio]) w->run_tail[prio]->run_next = q;
+    else w->run_head[prio] = q;
+    w->run_tail[prio] = q;
+    pthread_mutex_unlock(&w->mutex);
+    os_sem_post(decode_pool.work);
+}
+
+static struct decode_queue *run_list_pop(struct decode_worker *w, int prio) {
+    pthread_mutex_lock(&w->mutex);
+    struct decode_queue *q = w->run_head[prio];
+    if (q) {
+        w->run_head[prio] = q->run_next;
+        if (!w->run_head[prio]) w->run_tail[prio] = NULL;
+        q->run_next = NULL;
+    }
+    pthread_mutex_unlock(&w->mutex);
+    return q;
+}
+
+// Own list first, then steal, for each priority in turn
+static struct decode_queue *decode_pool_next(struct decode_worker *self) {
+    for (int prio = 0; prio < DECODE_PRIORITY_COUNT; prio++) {
+        for (int i = 0; i < decode_pool.worker_count; i++) {
+            struct decode_worker *w = &decode_pool.workers[(self->index + i) % decode_pool.worker_count];
+            struct decode_queue *q = run_list_pop(w, prio);
+            if (q) return q;
+        }
+    }
+    return NULL;
+}
+
+static void decode_queue_publish_stats(struct decode_queue *q, uint64_t now) {
+    double elapsed = (double)(now - q->window_start_ns);
+    struct decode_queue_stats st = {0};
+    st.fps = q->window_frames * 1e9 / elapsed;
+    st.delay_avg_ms = q->window_jobs ? q->window_delay_ns / (double)q->window_jobs / 1e6 : 0.0;
+    st.delay_max_ms = q->window_delay_max_ns / 1e6;
+    st.busy_pct = q->window_busy_ns * 100.0 / elapsed;
+    st.published_ns = now;
+
+    pthread_mutex_lock(&q->mutex);
+    st.depth_max = q->window_depth_max;
+    q->window_depth_max = q->depth;
+    q->stats = st;
+    pthread_mutex_unlock(&q->mutex);
+
+    if (++q->windows_published % DECODE_STATS_LOG_WINDOWS == 0) {
+        blog(LOG_INFO, "[OCAM] Decode '%s': %.1f fps, queue delay avg %.2f ms / max %.2f ms, depth max %d, worker busy %.1f%%",
+             q->name, st.fps, st.delay_avg_ms, st.delay_max_ms, st.depth_max, st.busy_pct);
+    }
+
+    q->window_start_ns = now;
+    q->window_jobs = q->window_frames = 0;
+    q->window_delay_ns = q->window_delay_max_ns = q->window_busy_ns = 0;
+}
+
+// Jobs and their packets are recycled per queue so steady-state streaming does not allocate
+static struct decode_job *decode_queue_get_job(struct decode_queue *q, enum decode_job_type type) {
+    pthread_mutex_lock(&q->mutex);
+    struct decode_job *job = q->free_jobs;
+    if (job) q->free_jobs = job->next;
+    pthread_mutex_unlock(&q->mutex);
+
+    if (!job) {
+        job = bzalloc(sizeof(struct decode_job));
+        job->packet = av_packet_alloc();
+        if (!job->packet) { bfree(job); return NULL; }
+    }
+
+    AVPacket *packet = job->packet;
+    memset(job, 0, sizeof(*job));
+    job->packet = packet;
+    job->type = type;
+    return job;
+}
+
+static void decode_queue_recycle_job(struct decode_queue *q, struct decode_job *job) {
+    av_packet_unref(job->packet);
+    pthread_mutex_lock(&q->mutex);
+    job->next = q->free_jobs;
+    q->free_jobs = job;
+    pthread_mutex_unlock(&q->mutex);
+}
+
+static bool decode_job_ends_picture(const struct decode_job *job) {
+    return job->type == DECODE_JOB_FRAME || (job->type == DECODE_JOB_SLICE && job->last_slice);
+}
+
+static void decode_queue_run(struct decode_worker *self, struct decode_queue *q) {
+    for (int n = 0; n < DECODE_BATCH; n++) {
+        pthread_mutex_lock(&q->mutex);
+        struct decode_job *job = q->head;
+        if (job) {
+            q->head = job->next;
+            if (!q->head) q->tail = NULL;
+            q->depth--;
+            if (decode_job_ends_picture(job)) q->pictures--;
+        }
+        pthread_mutex_unlock(&q->mutex);
+        if (!job) break;
+
+        uint64_t start = os_gettime_ns();
+        uint64_t delay = start - job->submit_ns;
+        int frames = q->process(q->data, job);
+        uint64_t end = os_gettime_ns();
+        decode_queue_recycle_job(q, job);
+
+        if (!q->window_start_ns) q->window_start_ns = start;
+        q->window_jobs++;
+        q->window_frames += frames;
+        q->window_delay_ns += delay;
+        if (delay > q->window_delay_max_ns) q->window_delay_max_ns = delay;
+        q->window_busy_ns += end - start;
+        if (end - q->window_start_ns >= DECODE_STATS_WINDOW_NS) decode_queue_publish_stats(q, end);
+    }
+
+    // Requeue on this worker if more work arrived, otherwise go idle
+    pthread_mutex_lock(&q->mutex);
+    bool more = q->head != NULL;
+    if (more) q->home = self->index;
+    else q->scheduled = false;
+    if (!more) pthread_cond_broadcast(&q->drained);
+    pthread_mutex_unlock(&q->mutex);
+
+    if (more) run_list_push(self, q);
+}
+
+static void *decode_worker_func(void *data) {
+    struct decode_worker *self = data;
+    char name[16];
+    snprintf(name, sizeof(name), "ocam-dec-%d", self->index);
+    struct thread_slot *slot = thread_policy_enter(STAGE_DECODE, name);
+
+    while (true) {
+        os_sem_wait(decode_pool.work);
+        if (!os_atomic_load_bool(&decode_pool.running)) break;
+
+        struct decode_queue *q = decode_pool_next(self);
+        if (q) decode_queue_run(self, q);
+        thread_policy_tick(slot);
+    }
+    thread_policy_exit(slot);
+    return NULL;
+}
+
+// Called with decode_pool.mutex held
+static void decode_pool_start(void) {
+    int cores = os_get_logical_cores();
+    if (cores < 1) cores = 1;
+    if (cores > DECODE_POOL_MAX_WORKERS) cores = DECODE_POOL_MAX_WORKERS;
+
+    os_sem_init(&decode_pool.work, 0);
+    os_atomic_store_bool(&decode_pool.running, true);
+    decode_pool.worker_count = cores;
+
+    for (int i = 0; i < cores; i++) {
+        struct decode_worker *w = &decode_pool.workers[i];
+        memset(w, 0, sizeof(*w));
+        w->index = i;
+        pthread_mutex_init(&w->mutex, NULL);
+        if (pthread_create(&w->thread, NULL, decode_worker_func, w) == 0) w->thread_active = true;
+    }
+    blog(LOG_INFO, "[OCAM] Decode pool started with %d workers.", cores);
+}
+
+// Called with decode_pool.mutex held, once every queue is gone
+static void decode_pool_stop(void) {
+    os_atomic_store_bool(&decode_pool.running, false);
+    for (int i = 0; i < decode_pool.worker_count; i++) os_sem_post(decode_pool.work);
+
+    for (int i = 0; i < decode_pool.worker_count; i++) {
+        struct decode_worker *w = &decode_pool.workers[i];
+        if (w->thread_active) pthread_join(w->thread, NULL);
+        w->thread_active = false;
+        pthread_mutex_destroy(&w->mutex);
+    }
+    os_sem_destroy(decode_pool.work);
+    decode_pool.work = NULL;
+    decode_pool.worker_count = 0;
+    blog(LOG_INFO, "[OCAM] Decode pool stopped.");
+}
+
+static void decode_queue_init(struct decode_queue *q, const char *name, int (*process)(void *, struct decode_job *), void *data) {
+    memset(q, 0, sizeof(*q));
+    pthread_mutex_init(&q->mutex, NULL);
+    pthread_cond_init(&q->drained, NULL);
+    q->process = process;
+    q->data = data;
+    q->name = name;
+    q->priority = DECODE_PRIORITY_NORMAL;
+
+    pthread_mutex_lock(&decode_pool.mutex);
+    if (decode_pool.refs++ == 0) decode_pool_start();
+    q->home = (int)(decode_pool.next_home++ % decode_pool.worker_count);
+    q->registry_next = decode_pool.registry;
+    decode_pool.registry = q;
+    decode_pool.registered++;
+    pthread_mutex_unlock(&decode_pool.mutex);
+}
+
+// Never blocks: control jobs must get through from OBS callbacks, and the ingest
+// side keeps picture latency bounded itself (see decode_queue_full)
+static void decode_queue_submit(struct decode_queue *q, struct decode_job *job) {
+    job->submit_ns = os_gettime_ns();
+    job->next = NULL;
+
+    pthread_mutex_lock(&q->mutex);
+    if (q->tail) q->tail->next = job;
+    else q->head = job;
+    q->tail = job;
+    q->depth++;
+    if (decode_job_ends_picture(job)) q->pictures++;
+    if (q->depth > q->window_depth_max) q->window_depth_max = q->depth;
+
+    bool wake = !q->scheduled;
+    q->scheduled = true;
+    int home = q->home;
+    pthread_mutex_unlock(&q->mutex);
+
+    if (wake) run_list_push(&decode_pool.workers[home], q);
+}
+
+// The decoder is a few pictures behind: queuing more would only add latency
+static bool decode_queue_full(struct decode_queue *q) {
+    pthread_mutex_lock(&q->mutex);
+    bool full = q->pictures >= DECODE_QUEUE_MAX_PICTURES;
+    pthread_mutex_unlock(&q->mutex);
+    return full;
+}
+
+static void decode_queue_wait_idle(struct decode_queue *q) {
+    pthread_mutex_lock(&q->mutex);
+    while (q->scheduled || q->head) pthread_cond_wait(&q->drained, &q->mutex);
+    pthread_mutex_unlock(&q->mutex);
+}
+
+static void decode_queue_set_priority(struct decode_queue *q, enum decode_priority prio) {
+    os_atomic_store_long(&q->priority, prio);
+}
+
+static bool decode_stats_current(const struct decode_queue_stats *st) {
+    return st->published_ns && os_gettime_ns() - st->published_ns < 2 * DECODE_STATS_WINDOW_NS;
+}
+
+// False when the queue has not decoded anything recently
+static bool decode_queue_get_stats(struct decode_queue *q, struct decode_queue_stats *st) {
+    pthread_mutex_lock(&q->mutex);
+    *st = q->stats;
+    pthread_mutex_unlock(&q->mutex);
+    return decode_stats_current(st);
+}
+
+static double decode_pool_total_fps(int *workers, int *sources) {
+    double total = 0.0;
+    pthread_mutex_lock(&decode_pool.mutex);
+    for (struct decode_queue *q = decode_pool.registry; q; q = q->registry_next) {
+        struct decode_queue_stats st;
+        if (decode_queue_get_stats(q, &st)) total += st.fps;
+    }
+    *workers = decode_pool.worker_count;
+    *sources = decode_pool.registered;
+    pthread_mutex_unlock(&decode_pool.mutex);
+    return total;
+}
+
+static void decode_queue_destroy(struct decode_queue *q) {
+    decode_queue_wait_idle(q);
+
+    pthread_mutex_lock(&decode_pool.mutex);
+    for (struct decode_queue **it = &decode_pool.registry; *it; it = &(*it)->registry_next) {
+        if (*it == q) { *it = q->registry_next; break; }
+    }
+    decode_pool.registered--;
+    if (--decode_pool.refs == 0) decode_pool_stop();
+    pthread_mutex_unlock(&decode_pool.mutex);
+
+    while (q->free_jobs) {
+        struct decode_job *job = q->free_jobs;
+        q->free_jobs = job->next;
+        decode_job_free(job);
+    }
+    pthread_cond_destroy(&q->drained);
+    pthread_mutex_destroy(&q->mutex);
+}
+
+/* --- Cadence Stats --- */
+// Rate and interval jitter of a periodic event (packet arrival, picture output).
+// Jitter is the mean change between consecutive intervals.
+
+#define CADENCE_WINDOW_NS 2000000000ULL
+
+struct cadence_window {
+    uint64_t start_ns;
+    uint64_t last_ns;
+    double last_interval_ms;
+    uint32_t count;
+    double sum_ms;
+    double jitter_sum_ms;
+    double max_ms;
+};
+
+struct cadence_stats {
+    double fps;
+    double interval_ms;
+    double jitter_ms;
+    double max_interval_ms;
+    uint64_t published_ns;
+};
+
+// Records one event; returns true when a finished window was written to out
+static bool cadence_tick(struct cadence_window *w, uint64_t now, struct cadence_stats *out) {
+    if (!w->last_ns) {
+        w->start_ns = w->last_ns = now;
+        return false;
+    }
+
+    double interval = (now - w->last_ns) / 1e6;
+    if (w->count > 0) w->jitter_sum_ms += interval > w->last_interval_ms ? interval - w->last_interval_ms : w->last_interval_ms - interval;
+    w->count++;
+    w->sum_ms += interval;
+    if (interval > w->max_ms) w->max_ms = interval;
+    w->last_interval_ms = interval;
+    w->last_ns = now;
+
+    if (now - w->start_ns < CADENCE_WINDOW_NS) return false;
+
+    out->fps = w->count * 1e9 / (double)(now - w->start_ns);
+    out->interval_ms = w->sum_ms / w->count;
+    out->jitter_ms = w->count > 1 ? w->jitter_sum_ms / (w->count - 1) : 0.0;
+    out->max_interval_ms = w->max_ms;
+    out->published_ns = now;
+
+    w->start_ns = now;
+    w->count = 0;
+    w->sum_ms = w->jitter_sum_ms = w->max_ms = 0.0;
+    return true;
+}
+
+static bool cadence_current(const struct cadence_stats *st) {
+    return st->published_ns && os_gettime_ns() - st->published_ns < 2 * CADENCE_WINDOW_NS;
+}
+
+#define OCAM_HIGH_SPEED_MAX_RATES 8
+
 struct ocam_res {
     int w;
     int h;
+    int high_speed_fps[OCAM_HIGH_SPEED_MAX_RATES];  // Rates above the regular maximum at this size
+    int high_speed_count;
 };
 
-struct ocam_source {
-    obs_source_t *source;
+// One H.264 decoder session
+struct ocam_decoder {
+    AVCodecContext *ctx;
+    const AVCodec *codec;     // Backend the session runs on
+    AVFrame *frame;
+    bool chunked;             // Opened for slice decoding
+    bool synced;              // Has been fed an IDR
+    uint32_t access_units;    // Access units fed since opening
+};
+
+// Compressed packets since the last IDR, replayed into a fresh decoder so a
+// subscriber that becomes visible gets the current picture without waiting for
+// the next keyframe. Only the decode worker touches it.
+#define GOP_CACHE_MAX_BYTES (16 * 1024 * 1024)
+
+struct gop_entry {
+    size_t offset;            // Into gop_cache.data, followed by input padding
+    int size;
+    int64_t pts;
+    int nal_type;             // First slice type (whole AU) or NAL type (slice)
+};
+
+struct gop_cache {
+    uint8_t *data;
+    size_t size, capacity;
+    struct gop_entry *entries;
+    size_t count, entries_capacity;
+    bool valid;               // Starts at an IDR and nothing was dropped since
+    bool chunked;             // Entries are slices
+    size_t au_start;          // Entry the current access unit starts at
+    bool au_idr;              // Current access unit already started a GOP
+};
+
+// Presentation pacer: decoded pictures waiting for their slot on the pts timeline
+#define PACER_MAX_FRAMES 16
+#define PACER_MAX_WINDOW_FRAMES 6
+#define PACER_MAX_WINDOW_MS 100
+#define PACER_RESYNC_NS 1000000000LL
+#define PACER_SLACK_TOLERANCE_NS 1000000LL
+
+struct pacer_frame {
+    AVFrame *frame;
+    int64_t target_ns;        // Release time
+    int64_t timestamp_ns;     // OBS timestamp, from the pts
+};
+
+struct pacer {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    struct pacer_frame frames[PACER_MAX_FRAMES];
+    int head, count;
+    int64_t window_ns;        // Jitter window, 0 = pictures pass straight through
+    bool anchored;
+    int64_t anchor_ns;        // Release time of pts_base_ns
+    int64_t pts_base_ns;
+    int64_t last_pts_ns;
+    int64_t min_slack_ns;     // Least time any picture waited this cadence window
+    uint32_t late;            // Pictures that arrived after their slot, since the last cadence log line
+    uint32_t dropped;         // Pictures pushed out by a full queue, since the last cadence log line
+};
+
+struct ocam_source;
+
+// One phone, keyed by its video port. Ingest, decode and control run once per
+// device no matter how many OBS sources subscribe to it.
+struct ocam_device {
+    int port;                 // Video; control and audio follow it
+    char name[32];            // For the log
+    long refs;                // device_registry.mutex
+    struct ocam_device *next;
+
+    // Subscribers (sub_mutex)
+    pthread_mutex_t sub_mutex;
+    struct ocam_source *subscribers;
+    int subscriber_count;
+    AVFrame *last_frame;      // Latest picture, shared by reference with late joiners
+    uint64_t last_frame_ts;
+
+    // Decode runs while any subscriber is visible (schedule_mutex)
+    pthread_mutex_t schedule_mutex;
+    bool decode_wanted;
 
     // Threads
     pthread_t network_thread;
@@ -90,6 +974,7 @@ struct ocam_source {
     bool audio_thread_active;
 
     // Sockets
+    volatile long bind_failed_port;  // Last port that could not be bound, 0 if none
     int video_server_fd;
     int video_client_fd;
     int control_server_fd;
@@ -116,16 +1001,68 @@ struct ocam_source {
     int current_exp;
     int current_focus;
 
+    int *supported_fps;
+    int supported_fps_count;
+    int regular_fps_max;         // Highest non-high-speed rate; 0 if the app does not say
+
     // Video State
     uint32_t width;
     uint32_t height;
-    AVCodecContext *codec_ctx;
-    AVFrame *decoded_frame;
+    struct ocam_decoder decoder;   // Live decoder, its pictures go to OBS
+    struct ocam_decoder pending;   // New stream warming up, swapped in on its first clean picture
     uint8_t *extradata;
     int extradata_size;
-    bool codec_initialized;
+    bool config_open;              // Last packet was config: another one extends extradata
     int64_t timestamp_offset;
     bool first_frame_received;
+    bool chunked_decode;       // Setting: feed slices to the decoder as they arrive
+    char backend_name[32];     // Setting: decoder backend, empty for the calibrated one (mutex)
+    const AVCodec *backend_rejected;  // Backend whose pictures OBS could not take (mutex)
+    long backend_generation;   // Worker: backend_cache.generation last checked
+    uint64_t last_picture_ns;  // When the decoder last produced a picture
+    bool au_keyframe;          // Slice mode: current access unit holds an IDR slice
+    uint32_t au_bytes;         // Slice mode: bytes of the current access unit decoded so far
+    uint64_t au_overlap_ns;    // Slice mode: decode time spent on earlier slices
+    uint64_t au_slice_done_ns; // Slice mode: when the latest non-final slice finished
+
+    // Ingest
+    AVBufferPool *packet_pool;     // Access unit payloads, sized to the largest seen
+    size_t packet_pool_size;
+    bool skip_to_idr;              // Decode queue was full: drop pictures until the next IDR
+    uint32_t skipped;              // Pictures dropped while skipping
+    struct cadence_window ingest_window;
+    struct cadence_window output_window;
+    struct cadence_stats ingest_stats;   // mutex
+    struct cadence_stats output_stats;   // mutex
+    uint32_t cadence_windows;
+
+    // Presentation
+    struct pacer pacer;
+    pthread_t pacer_thread;
+    bool pacer_thread_active;
+    int jitter_window_ms;      // Setting: -1 = Auto, 0 = Off
+    bool async_unbuffered;     // OBS async mode applied to subscribers (sub_mutex)
+    volatile long audio_delay_ns;  // Added to audio timestamps to match the video release delay
+    AVFrame *direct_frame;     // Worker: picture shown without pacing
+    struct cadence_window present_window;
+    struct cadence_stats present_stats;  // mutex
+
+    // Decode scheduling
+    struct decode_queue video_queue;
+    bool video_queue_active;
+    bool decoding;             // Worker: decoder is running, not just caching
+    bool replaying;            // Worker: GOP replay, keep pictures without output
+    struct gop_cache gop;
+    AVPacket *replay_packet;
+
+    // Keyframe latency stats (receive-to-picture)
+    bool kf_chunked;
+    uint32_t kf_count;
+    uint64_t kf_bytes_total;
+    uint64_t kf_recv_ns_total;      // first payload byte -> last payload byte
+    uint64_t kf_picture_ns_total;   // first payload byte -> picture out
+    uint64_t kf_tail_ns_total;      // last payload byte  -> picture out
+    uint64_t kf_overlap_ns_total;   // decode time spent while still receiving
 
     // Audio State
     AVCodecContext *audio_codec_ctx;
@@ -137,9 +1074,32 @@ struct ocam_source {
     bool first_audio_received;
 };
 
+// One OBS source showing a device's stream
+struct ocam_source {
+    obs_source_t *source;
+    struct ocam_device *device;
+    struct ocam_source *next;      // device->subscribers
+    int port;
+    int requested_port;            // Port setting, which differs from port while it conflicts
+    int port_conflict;             // Device whose ports overlap the requested port, 0 if none
+    obs_data_t *applied;           // Settings last sent to the device, NULL until the first update on it
+
+    // device->sub_mutex
+    int decode_priority;           // Setting: 0 = Auto, 1 = High, 2 = Normal
+    bool program_active;
+    bool showing;
+    uint32_t width;
+    uint32_t height;
+};
+
+static struct {
+    pthread_mutex_t mutex;
+    struct ocam_device *head;
+} device_registry;
+
 // Helper: Wait for data or timeout, returning false if thread stops
-static bool wait_for_socket(int fd, struct ocam_source *s, bool read) {
-    while (s->thread_running) {
+static bool wait_for_socket(int fd, struct ocam_device *dev, bool read) {
+    while (dev->thread_running) {
         fd_set set;
         FD_ZERO(&set);
         FD_SET(fd, &set);
@@ -156,10 +1116,10 @@ static bool wait_for_socket(int fd, struct ocam_source *s, bool read) {
     return false;
 }
 
-static ssize_t read_bytes_fully(int fd, void *buf, size_t len, struct ocam_source *s) {
+static ssize_t read_bytes_fully(int fd, void *buf, size_t len, struct ocam_device *dev) {
     size_t total_read = 0;
-    while (total_read < len && s->thread_running) {
-        if (!wait_for_socket(fd, s, true)) return -1;
+    while (total_read < len && dev->thread_running) {
+        if (!wait_for_socket(fd, dev, true)) return -1;
         
         ssize_t bytes_read = recv(fd, (char*)buf + total_read, (int)(len - total_read), 0);
         if (bytes_read <= 0) return bytes_read;
@@ -168,36 +1128,84 @@ static ssize_t read_bytes_fully(int fd, void *buf, size_t len, struct ocam_sourc
     return total_read;
 }
 
-static int accept_with_timeout(int server_fd, struct ocam_source *s) {
-    if (!wait_for_socket(server_fd, s, true)) return -1;
+// Buffered reader for the video socket: one select/recv pair serves many small
+// header fields at high frame rates, and large payloads bypass the buffer.
+#define SOCKET_READER_SIZE (64 * 1024)
+
+struct socket_reader {
+    int fd;
+    size_t pos;
+    size_t len;
+    uint8_t buf[SOCKET_READER_SIZE];
+};
+
+static void reader_reset(struct socket_reader *r, int fd) {
+    r->fd = fd;
+    r->pos = r->len = 0;
+}
+
+// Reads whatever is available (at most len bytes), from the buffer first
+static ssize_t reader_read_some(struct socket_reader *r, void *dst, size_t len, struct ocam_device *dev) {
+    if (r->pos == r->len) {
+        if (!wait_for_socket(r->fd, dev, true)) return -1;
+        if (len >= sizeof(r->buf)) return recv(r->fd, (char*)dst, (int)len, 0);
+
+        ssize_t n = recv(r->fd, (char*)r->buf, (int)sizeof(r->buf), 0);
+        if (n <= 0) return n;
+        r->pos = 0;
+        r->len = (size_t)n;
+    }
+
+    size_t n = r->len - r->pos;
+    if (n > len) n = len;
+    memcpy(dst, r->buf + r->pos, n);
+    r->pos += n;
+    return (ssize_t)n;
+}
+
+static ssize_t reader_read_fully(struct socket_reader *r, void *dst, size_t len, struct ocam_device *dev) {
+    size_t total_read = 0;
+    while (total_read < len && dev->thread_running) {
+        ssize_t bytes_read = reader_read_some(r, (char*)dst + total_read, len - total_read, dev);
+        if (bytes_read <= 0) return bytes_read;
+        total_read += bytes_read;
+    }
+    return total_read;
+}
+
+static int accept_with_timeout(int server_fd, struct ocam_device *dev) {
+    if (!wait_for_socket(server_fd, dev, true)) return -1;
     return (int)accept(server_fd, NULL, NULL);
 }
 
-static void send_control_command(struct ocam_source *s, uint8_t cmd_id, uint32_t arg1, uint32_t arg2) {
-    pthread_mutex_lock(&s->mutex);
-    if (s->control_client_fd != -1) {
+static void send_control_command(struct ocam_device *dev, uint8_t cmd_id, uint32_t arg1, uint32_t arg2) {
+    pthread_mutex_lock(&dev->mutex);
+    if (dev->control_client_fd != -1) {
         uint8_t buffer[9];
         buffer[0] = cmd_id;
         buffer[1] = (arg1 >> 24) & 0xFF; buffer[2] = (arg1 >> 16) & 0xFF; buffer[3] = (arg1 >> 8) & 0xFF; buffer[4] = (arg1) & 0xFF;
         buffer[5] = (arg2 >> 24) & 0xFF; buffer[6] = (arg2 >> 16) & 0xFF; buffer[7] = (arg2 >> 8) & 0xFF; buffer[8] = (arg2) & 0xFF;
         
-        if (send(s->control_client_fd, (const char*)buffer, 9, MSG_NOSIGNAL) < 0) {
+        if (send(dev->control_client_fd, (const char*)buffer, 9, MSG_NOSIGNAL) < 0) {
             blog(LOG_WARNING, "[OCAM] Send Error: Connection lost");
         }
     }
-    pthread_mutex_unlock(&s->mutex);
+    pthread_mutex_unlock(&dev->mutex);
 }
 
-static int create_bind_socket(int port) {
+// Retries for a few seconds in case a previous listener is still closing. Ports are
+// bound exclusively so two devices (or another program) can never share one silently.
+static int create_bind_socket(struct ocam_device *dev, int port) {
     int fd;
     int opt = 1;
     struct sockaddr_in address;
 
-    if ((fd = (int)socket(AF_INET, SOCK_STREAM, 0)) == 0) return -1;
+    if ((fd = (int)socket(AF_INET, SOCK_STREAM, 0)) < 0) return -1;
 
+    #ifdef _WIN32
+    setsockopt(fd, SOL_SOCKET, SO_EXCLUSIVEADDRUSE, (SOCKOPT_VAL_TYPE)&opt, sizeof(opt));
+    #else
     setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (SOCKOPT_VAL_TYPE)&opt, sizeof(opt));
-    #ifdef SO_REUSEPORT
-    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, (SOCKOPT_VAL_TYPE)&opt, sizeof(opt));
     #endif
 
     setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (SOCKOPT_VAL_TYPE)&opt, sizeof(opt));
@@ -206,95 +1214,138 @@ static int create_bind_socket(int port) {
     address.sin_addr.s_addr = INADDR_ANY;
     address.sin_port = htons(port);
 
-    int retries = 5;
-    while (retries > 0) {
-        if (bind(fd, (struct sockaddr *)&address, sizeof(address)) < 0) {
-            blog(LOG_WARNING, "[OCAM] Bind retry port %d...", port);
-            os_sleep_ms(1000);
-            retries--;
-        } else {
-            return fd;
-        }
+    for (int retries = 5; retries > 0 && dev->thread_running; retries--) {
+        if (bind(fd, (struct sockaddr *)&address, sizeof(address)) == 0) return fd;
+        blog(LOG_WARNING, "[OCAM] Bind retry port %d...", port);
+        // Sleep in short steps so a device being destroyed does not wait out the retries
+        for (int i = 0; i < 10 && dev->thread_running; i++) os_sleep_ms(100);
+    }
+    CLOSESOCKET(fd);
+    if (dev->thread_running) {
+        blog(LOG_ERROR, "[OCAM] Could not bind port %d; it is used by another program or OCam source", port);
+        os_atomic_store_long(&dev->bind_failed_port, port);
     }
     return -1;
 }
 
-static void sync_settings_to_phone(struct ocam_source *s) {
-    if (s->current_w > 0 && s->current_h > 0) {
-        send_control_command(s, 0x01, s->current_w, s->current_h);
+static void sync_settings_to_phone(struct ocam_device *dev) {
+    if (dev->current_w > 0 && dev->current_h > 0) {
+        send_control_command(dev, 0x01, dev->current_w, dev->current_h);
         os_sleep_ms(50);
     }
-    if (s->current_fps > 0) send_control_command(s, 0x02, s->current_fps, 0);
-    if (s->current_bitrate > 0) send_control_command(s, 0x03, s->current_bitrate * 1000000, 0);
+    if (dev->current_fps > 0) send_control_command(dev, 0x02, dev->current_fps, 0);
+    if (dev->current_bitrate > 0) send_control_command(dev, 0x03, dev->current_bitrate * 1000000, 0);
 
-    send_control_command(s, 0x09, s->current_flash ? 1 : 0, 0);
-    if (s->current_iso >= 0) send_control_command(s, 0x06, s->current_iso, 0);
-    if (s->current_exp >= 0) send_control_command(s, 0x07, s->current_exp, 0);
-    if (s->current_focus >= -1) send_control_command(s, 0x08, s->current_focus, 0);
+    send_control_command(dev, 0x09, dev->current_flash ? 1 : 0, 0);
+    if (dev->current_iso >= 0) send_control_command(dev, 0x06, dev->current_iso, 0);
+    if (dev->current_exp >= 0) send_control_command(dev, 0x07, dev->current_exp, 0);
+    if (dev->current_focus >= -1) send_control_command(dev, 0x08, dev->current_focus, 0);
 }
 
 static void *control_thread_func(void *data) {
-    struct ocam_source *s = data;
+    struct ocam_device *dev = data;
 
-    s->control_server_fd = create_bind_socket(CONTROL_PORT);
-    if (s->control_server_fd < 0) return NULL;
-    if (listen(s->control_server_fd, 1) < 0) { CLOSESOCKET(s->control_server_fd); return NULL; }
+    dev->control_server_fd = create_bind_socket(dev, dev->port + CONTROL_PORT - VIDEO_PORT);
+    if (dev->control_server_fd < 0) return NULL;
+    if (listen(dev->control_server_fd, 1) < 0) { CLOSESOCKET(dev->control_server_fd); return NULL; }
 
+    char thread_name[16];
+    snprintf(thread_name, sizeof(thread_name), "ocam-ctl-%d", dev->port);
+    struct thread_slot *slot = thread_policy_enter(STAGE_CONTROL, thread_name);
     uint8_t trash_buffer[1024];
 
-    while (s->thread_running) {
-        int client = accept_with_timeout(s->control_server_fd, s);
+    while (dev->thread_running) {
+        thread_policy_tick(slot);
+        int client = accept_with_timeout(dev->control_server_fd, dev);
 
         if (client < 0) continue;
-        if (!s->thread_running) { CLOSESOCKET(client); break; }
+        if (!dev->thread_running) { CLOSESOCKET(client); break; }
         
         // TCP_NODELAY
         int opt = 1;
         setsockopt(client, IPPROTO_TCP, TCP_NODELAY, (SOCKOPT_VAL_TYPE)&opt, sizeof(opt));
 
-        pthread_mutex_lock(&s->mutex);
-        s->control_client_fd = client;
-        pthread_mutex_unlock(&s->mutex);
+        pthread_mutex_lock(&dev->mutex);
+        dev->control_client_fd = client;
+        pthread_mutex_unlock(&dev->mutex);
 
         blog(LOG_INFO, "[OCAM-CTRL] Connected. Syncing settings...");
-        sync_settings_to_phone(s);
-        send_control_command(s, 0x05, 0, 0);
+        sync_settings_to_phone(dev);
+        send_control_command(dev, 0x05, 0, 0);
 
-        while (s->thread_running) {
+        while (dev->thread_running) {
+            thread_policy_tick(slot);
             uint8_t header[5];
-            if (read_bytes_fully(client, header, 5, s) <= 0) break;
+            if (read_bytes_fully(client, header, 5, dev) <= 0) break;
 
             uint8_t pkt_type = header[0];
             uint32_t payload_len = portable_ntohl(*(uint32_t*)(header + 1));
 
             if (pkt_type == 0x10) {
                 uint8_t *payload = malloc(payload_len);
-                if (read_bytes_fully(client, payload, payload_len, s) == payload_len) {
+                if (read_bytes_fully(client, payload, payload_len, dev) == payload_len) {
 
-                    pthread_mutex_lock(&s->mutex);
+                    pthread_mutex_lock(&dev->mutex);
                     int offset = 0;
                     uint8_t res_count = payload[offset++];
 
-                    if (s->supported_resolutions) free(s->supported_resolutions);
-                    s->supported_resolutions = malloc(sizeof(struct ocam_res) * res_count);
-                    s->supported_res_count = res_count;
+                    if (dev->supported_resolutions) free(dev->supported_resolutions);
+                    dev->supported_resolutions = malloc(sizeof(struct ocam_res) * res_count);
+                    dev->supported_res_count = res_count;
 
                     for(int i=0; i<res_count; i++) {
                         uint32_t w = portable_ntohl(*(uint32_t*)(payload + offset)); offset += 4;
                         uint32_t h = portable_ntohl(*(uint32_t*)(payload + offset)); offset += 4;
-                        s->supported_resolutions[i].w = w;
-                        s->supported_resolutions[i].h = h;
+                        memset(&dev->supported_resolutions[i], 0, sizeof(struct ocam_res));
+                        dev->supported_resolutions[i].w = w;
+                        dev->supported_resolutions[i].h = h;
                     }
 
-                    s->iso_min = (int32_t)portable_ntohl(*(uint32_t*)(payload + offset)); offset += 4;
-                    s->iso_max = (int32_t)portable_ntohl(*(uint32_t*)(payload + offset)); offset += 4;
-                    s->exp_min = (int32_t)portable_ntohl(*(uint32_t*)(payload + offset)); offset += 4;
-                    s->exp_max = (int32_t)portable_ntohl(*(uint32_t*)(payload + offset)); offset += 4;
-                    s->focus_min = befloattoh(*(uint32_t*)(payload + offset)); offset += 4;
-                    s->flash_available = payload[offset++];
+                    dev->iso_min = (int32_t)portable_ntohl(*(uint32_t*)(payload + offset)); offset += 4;
+                    dev->iso_max = (int32_t)portable_ntohl(*(uint32_t*)(payload + offset)); offset += 4;
+                    dev->exp_min = (int32_t)portable_ntohl(*(uint32_t*)(payload + offset)); offset += 4;
+                    dev->exp_max = (int32_t)portable_ntohl(*(uint32_t*)(payload + offset)); offset += 4;
+                    dev->focus_min = befloattoh(*(uint32_t*)(payload + offset)); offset += 4;
+                    dev->flash_available = payload[offset++];
+
+                    // Optional: frame rates the phone can stream (older apps omit the list)
+                    if (dev->supported_fps) { free(dev->supported_fps); dev->supported_fps = NULL; }
+                    dev->supported_fps_count = 0;
+                    if (offset < (int)payload_len) {
+                        uint8_t fps_count = payload[offset++];
+                        if (offset + fps_count * 4 <= (int)payload_len) {
+                            dev->supported_fps = malloc(sizeof(int) * fps_count);
+                            for (int i = 0; i < fps_count; i++) {
+                                dev->supported_fps[i] = (int32_t)portable_ntohl(*(uint32_t*)(payload + offset)); offset += 4;
+                            }
+                            dev->supported_fps_count = fps_count;
+                        }
+                    }
+
+                    // Optional: the regular maximum and the sizes that support high-speed rates.
+                    // Without it every rate is offered at every size.
+                    dev->regular_fps_max = 0;
+                    if (offset + 5 <= (int)payload_len) {
+                        dev->regular_fps_max = (int32_t)portable_ntohl(*(uint32_t*)(payload + offset)); offset += 4;
+                        uint8_t hs_count = payload[offset++];
+                        for (int i = 0; i < hs_count && offset + 9 <= (int)payload_len; i++) {
+                            int w = (int32_t)portable_ntohl(*(uint32_t*)(payload + offset)); offset += 4;
+                            int h = (int32_t)portable_ntohl(*(uint32_t*)(payload + offset)); offset += 4;
+                            uint8_t rate_count = payload[offset++];
+                            if (offset + rate_count * 4 > (int)payload_len) break;
+
+                            struct ocam_res *res = NULL;
+                            for (int r = 0; r < dev->supported_res_count && !res; r++)
+                                if (dev->supported_resolutions[r].w == w && dev->supported_resolutions[r].h == h) res = &dev->supported_resolutions[r];
+                            for (int r = 0; r < rate_count; r++) {
+                                int rate = (int32_t)portable_ntohl(*(uint32_t*)(payload + offset)); offset += 4;
+                                if (res && res->high_speed_count < OCAM_HIGH_SPEED_MAX_RATES) res->high_speed_fps[res->high_speed_count++] = rate;
+                            }
+                        }
+                    }
 
-                    s->caps_received = true;
-                    pthread_mutex_unlock(&s->mutex);
+                    dev->caps_received = true;
+                    pthread_mutex_unlock(&dev->mutex);
 
                     blog(LOG_INFO, "[OCAM] Capabilities updated.");
                 }
@@ -303,490 +1354,2173 @@ static void *control_thread_func(void *data) {
                 size_t remaining = payload_len;
                 while(remaining > 0) {
                     size_t to_read = (remaining > sizeof(trash_buffer)) ? sizeof(trash_buffer) : remaining;
-                    if (read_bytes_fully(client, trash_buffer, to_read, s) <= 0) break;
+                    if (read_bytes_fully(client, trash_buffer, to_read, dev) <= 0) break;
                     remaining -= to_read;
                 }
             }
         }
 
-        pthread_mutex_lock(&s->mutex);
-        if (s->control_client_fd != -1) { CLOSESOCKET(s->control_client_fd); s->control_client_fd = -1; }
-        s->caps_received = false;
-        pthread_mutex_unlock(&s->mutex);
+        pthread_mutex_lock(&dev->mutex);
+        if (dev->control_client_fd != -1) { CLOSESOCKET(dev->control_client_fd); dev->control_client_fd = -1; }
+        dev->caps_received = false;
+        pthread_mutex_unlock(&dev->mutex);
     }
-    CLOSESOCKET(s->control_server_fd);
+    CLOSESOCKET(dev->control_server_fd);
+    thread_policy_exit(slot);
     return NULL;
 }
 
-static obs_properties_t *ocam_get_properties(void *data) {
-    struct ocam_source *s = data;
-    obs_properties_t *props = obs_properties_create();
+// --- Video FFmpeg Utils ---
 
-    obs_property_t *list = obs_properties_add_list(props, "resolution", "Resolution", OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
-    pthread_mutex_lock(&s->mutex);
-    if (s->caps_received && s->supported_res_count > 0) {
-        for (int i = 0; i < s->supported_res_count; i++) {
-            struct dstr label = {0};
-            dstr_printf(&label, "%dx%d", s->supported_resolutions[i].w, s->supported_resolutions[i].h);
-            obs_property_list_add_string(list, label.array, label.array);
-            dstr_free(&label);
-        }
-    } else {
-        obs_property_list_add_string(list, "1280x720", "1280x720");
-        obs_property_list_add_string(list, "1920x1080", "1920x1080");
-        if (!s->caps_received) obs_property_set_description(list, "Resolution (Connect phone to populate)");
+static inline enum video_format convert_pixel_format(int f) {
+    switch (f) {
+        case AV_PIX_FMT_YUV420P: return VIDEO_FORMAT_I420;
+        case AV_PIX_FMT_YUVJ420P: return VIDEO_FORMAT_I420;
+        case AV_PIX_FMT_NV12: return VIDEO_FORMAT_NV12;
+        default: return VIDEO_FORMAT_NONE;
     }
+}
 
-    obs_property_t *fps_list = obs_properties_add_list(props, "fps", "FPS", OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
-    obs_property_list_add_int(fps_list, "60 FPS", 60);
-    obs_property_list_add_int(fps_list, "30 FPS", 30);
-    obs_property_list_add_int(fps_list, "24 FPS", 24);
-    obs_property_list_add_int(fps_list, "15 FPS", 15);
+static inline enum video_colorspace convert_color_space(enum AVColorSpace s) {
+    switch (s) {
+        case AVCOL_SPC_BT709: return VIDEO_CS_709;
+        case AVCOL_SPC_SMPTE170M: return VIDEO_CS_601;
+        default: return VIDEO_CS_DEFAULT;
+    }
+}
 
-    obs_property_t *bit_list = obs_properties_add_list(props, "bitrate", "Bitrate", OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
-    obs_property_list_add_int(bit_list, "1 Mbps", 1);
-    obs_property_list_add_int(bit_list, "2 Mbps", 2);
-    obs_property_list_add_int(bit_list, "4 Mbps", 4);
-    obs_property_list_add_int(bit_list, "6 Mbps", 6);
-    obs_property_list_add_int(bit_list, "8 Mbps", 8);
-    obs_property_list_add_int(bit_list, "12 Mbps", 12);
-    obs_property_list_add_int(bit_list, "20 Mbps", 20);
-    obs_property_list_add_int(bit_list, "50 Mbps (High)", 50);
+static void decoder_close(struct ocam_decoder *d) {
+    if (d->ctx) avcodec_free_context(&d->ctx);
+    if (d->frame) av_frame_free(&d->frame);
+    memset(d, 0, sizeof(*d));
+}
 
-    obs_properties_add_bool(props, "flash", "Flash / Torch");
+static void cleanup_ffmpeg(struct ocam_device *dev) {
+    decoder_close(&dev->decoder);
+    decoder_close(&dev->pending);
+    if (dev->extradata) { free(dev->extradata); dev->extradata = NULL; }
+    dev->extradata_size = 0;
+    dev->config_open = false;
+}
 
-    obs_properties_t *manual_grp = obs_properties_create();
-    int iso_max = (s->caps_received && s->iso_max > 0) ? s->iso_max : 3200;
-    obs_properties_add_int_slider(manual_grp, "iso", "ISO (0=Auto)", 0, iso_max, 1);
-    int exp_max = (s->caps_received && s->exp_max > 0) ? s->exp_max : 100000;
-    obs_properties_add_int_slider(manual_grp, "exposure", "Exposure µs (0=Auto)", 0, exp_max, 100);
-    obs_properties_add_int_slider(manual_grp, "focus", "Focus (-1=Auto, 0-1000 Manual)", -1, 1000, 1);
+// Session options shared by live decoders and calibration, so calibration times what will run
+static void decoder_configure(AVCodecContext *ctx, bool chunked) {
+    ctx->flags |= AV_CODEC_FLAG_LOW_DELAY;
+    av_opt_set(ctx->priv_data, "tune", "zerolatency", 0);
 
-    pthread_mutex_unlock(&s->mutex);
-    obs_properties_add_group(props, "manual_controls", "Manual Controls", OBS_GROUP_NORMAL, manual_grp);
-    return props;
+    // Parallelism comes from the shared decode pool, not from per-decoder threads
+    ctx->thread_count = 1;
+
+    // Slice mode: packets may end at any NAL boundary. Frame threading needs whole access units.
+    if (chunked) {
+        ctx->flags2 |= AV_CODEC_FLAG2_CHUNKS;
+        ctx->thread_type = FF_THREAD_SLICE;
+    }
 }
 
-static void ocam_get_defaults(obs_data_t *settings) {
-    obs_data_set_default_string(settings, "resolution", "1280x720");
-    obs_data_set_default_int(settings, "fps", 30);
-    obs_data_set_default_int(settings, "bitrate", 2);
-    obs_data_set_default_bool(settings, "flash", false);
-    obs_data_set_default_int(settings, "iso", 0);
-    obs_data_set_default_int(settings, "exposure", 0);
-    obs_data_set_default_int(settings, "focus", -1);
+static bool decoder_open(struct ocam_device *dev, struct ocam_decoder *d, bool chunked, const AVCodec *codec) {
+    const AVCodec *native = avcodec_find_decoder(AV_CODEC_ID_H264);
+    if (!codec) codec = native;
+    if (!codec) return false;
+
+    d->ctx = avcodec_alloc_context3(codec);
+    if (!d->ctx) return false;
+    if (dev->extradata_size > 0) {
+        d->ctx->extradata = (uint8_t*)av_mallocz(dev->extradata_size + AV_INPUT_BUFFER_PADDING_SIZE);
+        memcpy(d->ctx->extradata, dev->extradata, dev->extradata_size);
+        d->ctx->extradata_size = dev->extradata_size;
+    }
+
+    decoder_configure(d->ctx, chunked);
+    d->chunked = chunked;
+
+    d->frame = av_frame_alloc();
+    if (!d->frame || avcodec_open2(d->ctx, codec, NULL) < 0) {
+        decoder_close(d);
+        // A backend that will not open falls back to the built-in decoder
+        return codec != native && decoder_open(dev, d, chunked, native);
+    }
+    d->codec = codec;
+    return true;
 }
 
-static void ocam_update(void *data, obs_data_t *settings) {
-    struct ocam_source *s = data;
+// The decoder new packets go to: the pending one while it is warming up
+static struct ocam_decoder *input_decoder(struct ocam_device *dev) {
+    return dev->pending.ctx ? &dev->pending : &dev->decoder;
+}
 
-    const char *res_str = obs_data_get_string(settings, "resolution");
-    int w = 0, h = 0;
-    if (sscanf(res_str, "%dx%d", &w, &h) == 2) {
-        if (w != s->current_w || h != s->current_h) {
-            blog(LOG_INFO, "[OCAM] Setting Resolution: %dx%d", w, h);
-            send_control_command(s, 0x01, w, h);
-            s->current_w = w; s->current_h = h;
+// A fresh decoder gets nothing before its first IDR, so it never shows reference errors
+static bool decoder_accepts(struct ocam_decoder *d, int nal_type) {
+    if (d->synced) return true;
+    if (nal_type >= 1 && nal_type <= 4) return false;
+    if (nal_type == 5) d->synced = true;
+    return true;
+}
+
+static bool frame_is_clean_keyframe(const AVFrame *f) {
+#ifdef AV_FRAME_FLAG_KEY
+    bool key = (f->flags & AV_FRAME_FLAG_KEY) != 0;
+#else
+    bool key = f->key_frame != 0;
+#endif
+    return key && !f->decode_error_flags && !(f->flags & AV_FRAME_FLAG_CORRUPT);
+}
+
+// The pending decoder produced its first clean picture: make it live and free the old session
+static void swap_in_pending(struct ocam_device *dev) {
+    decoder_close(&dev->decoder);
+    dev->decoder = dev->pending;
+    memset(&dev->pending, 0, sizeof(dev->pending));
+    blog(LOG_INFO, "[OCAM] Switched to new stream (%dx%d, %s decode, %s).", dev->decoder.frame->width, dev->decoder.frame->height,
+         dev->decoder.chunked ? "slice" : "frame", dev->decoder.codec->name);
+}
+
+// --- Decoder Backends ---
+// Any H.264 decoder libavcodec was built with (native, libopenh264, hardware
+// wrappers returning system-memory frames) can run a frame-mode session. The first
+// full GOP a phone sends at a new resolution is decoded by every backend on a
+// background thread, and the fastest one that keeps up with the frame rate without
+// holding pictures back becomes the default. Results are cached per machine.
+
+#define BACKEND_MAX 8
+#define BACKEND_CACHE_MAX 8
+#define BACKEND_CACHE_FILE "decoder-backends.json"
+#define CALIBRATION_MIN_FRAMES 15
+#define CALIBRATION_TARGET_DECODES 120
+#define CALIBRATION_MAX_PASSES 8
+
+struct backend_result {
+    char name[32];
+    bool ok;                  // Opened and produced pictures OBS can take
+    bool in_budget;           // Keeps up with the frame rate without delay
+    double avg_ms;            // Decode time per access unit
+    double p95_ms;
+    int delay_frames;         // Pictures held back by the decoder
+};
+
+struct backend_calibration {
+    int width, height;
+    double budget_ms;         // Frame interval of the calibration clip
+    char selected[32];        // Empty: nothing qualified, use the native decoder
+    int result_count;
+    struct backend_result results[BACKEND_MAX];
+};
+
+// Access units copied out of a device's GOP cache
+struct calibration_clip {
+    int width, height;
+    double interval_ms;
+    uint8_t *extradata;
+    int extradata_size;
+    uint8_t *data;
+    struct gop_entry *units;
+    size_t count;
+};
+
+static struct {
+    pthread_mutex_t mutex;
+    bool loaded;
+    int count;
+    struct backend_calibration entries[BACKEND_CACHE_MAX];
+    pthread_t thread;
+    bool thread_active;
+    bool running;
+    volatile long generation;     // Bumped whenever the backend choice may have changed
+} backend_cache;
+
+static struct backend_calibration *backend_cache_find(int width, int height) {
+    for (int i = 0; i < backend_cache.count; i++) {
+        struct backend_calibration *c = &backend_cache.entries[i];
+        if (c->width == width && c->height == height) return c;
+    }
+    return NULL;
+}
+
+static void backend_cache_load(void) {
+    if (backend_cache.loaded) return;
+    backend_cache.loaded = true;
+
+    char *path = obs_module_config_path(BACKEND_CACHE_FILE);
+    obs_data_t *root = path ? obs_data_create_from_json_file_safe(path, "bak") : NULL;
+    bfree(path);
+    if (!root) return;
+
+    // Numbers from another libavcodec build say nothing about this one
+    if ((unsigned)obs_data_get_int(root, "avcodec_version") == avcodec_version()) {
+        obs_data_array_t *list = obs_data_get_array(root, "calibrations");
+        size_t count = list ? obs_data_array_count(list) : 0;
+        for (size_t i = 0; i < count && backend_cache.count < BACKEND_CACHE_MAX; i++) {
+            obs_data_t *item = obs_data_array_item(list, i);
+            struct backend_calibration *c = &backend_cache.entries[backend_cache.count++];
+            memset(c, 0, sizeof(*c));
+            c->width = (int)obs_data_get_int(item, "width");
+            c->height = (int)obs_data_get_int(item, "height");
+            c->budget_ms = obs_data_get_double(item, "budget_ms");
+            snprintf(c->selected, sizeof(c->selected), "%s", obs_data_get_string(item, "selected"));
+
+            obs_data_array_t *results = obs_data_get_array(item, "results");
+            size_t result_count = results ? obs_data_array_count(results) : 0;
+            for (size_t j = 0; j < result_count && c->result_count < BACKEND_MAX; j++) {
+                obs_data_t *r = obs_data_array_item(results, j);
+                struct backend_result *res = &c->results[c->result_count++];
+                snprintf(res->name, sizeof(res->name), "%s", obs_data_get_string(r, "name"));
+                res->ok = obs_data_get_bool(r, "ok");
+                res->in_budget = obs_data_get_bool(r, "in_budget");
+                res->avg_ms = obs_data_get_double(r, "avg_ms");
+                res->p95_ms = obs_data_get_double(r, "p95_ms");
+                res->delay_frames = (int)obs_data_get_int(r, "delay_frames");
+                obs_data_release(r);
+            }
+            obs_data_array_release(results);
+            obs_data_release(item);
         }
+        obs_data_array_release(list);
     }
+    obs_data_release(root);
+}
 
-    int fps = (int)obs_data_get_int(settings, "fps");
-    if (fps != s->current_fps) {
-        blog(LOG_INFO, "[OCAM] Setting FPS: %d", fps);
-        send_control_command(s, 0x02, fps, 0);
-        s->current_fps = fps;
+static void backend_cache_save(void) {
+    obs_data_t *root = obs_data_create();
+    obs_data_set_int(root, "avcodec_version", avcodec_version());
+
+    obs_data_array_t *list = obs_data_array_create();
+    for (int i = 0; i < backend_cache.count; i++) {
+        const struct backend_calibration *c = &backend_cache.entries[i];
+        obs_data_t *item = obs_data_create();
+        obs_data_set_int(item, "width", c->width);
+        obs_data_set_int(item, "height", c->height);
+        obs_data_set_double(item, "budget_ms", c->budget_ms);
+        obs_data_set_string(item, "selected", c->selected);
+
+        obs_data_array_t *results = obs_data_array_create();
+        for (int j = 0; j < c->result_count; j++) {
+            const struct backend_result *res = &c->results[j];
+            obs_data_t *r = obs_data_create();
+            obs_data_set_string(r, "name", res->name);
+            obs_data_set_bool(r, "ok", res->ok);
+            obs_data_set_bool(r, "in_budget", res->in_budget);
+            obs_data_set_double(r, "avg_ms", res->avg_ms);
+            obs_data_set_double(r, "p95_ms", res->p95_ms);
+            obs_data_set_int(r, "delay_frames", res->delay_frames);
+            obs_data_array_push_back(results, r);
+            obs_data_release(r);
+        }
+        obs_data_set_array(item, "results", results);
+        obs_data_array_release(results);
+        obs_data_array_push_back(list, item);
+        obs_data_release(item);
     }
+    obs_data_set_array(root, "calibrations", list);
+    obs_data_array_release(list);
+
+    char *dir = obs_module_config_path("");
+    char *path = obs_module_config_path(BACKEND_CACHE_FILE);
+    if (dir && path) {
+        os_mkdirs(dir);
+        if (!obs_data_save_json_safe(root, path, "tmp", "bak")) blog(LOG_WARNING, "[OCAM] Could not save %s", path);
+    }
+    bfree(dir);
+    bfree(path);
+    obs_data_release(root);
+}
 
-    int bitrate_mbps = (int)obs_data_get_int(settings, "bitrate");
-    if (bitrate_mbps != s->current_bitrate) {
-        blog(LOG_INFO, "[OCAM] Setting Bitrate: %d Mbps", bitrate_mbps);
-        send_control_command(s, 0x03, bitrate_mbps * 1000000, 0);
-        s->current_bitrate = bitrate_mbps;
+// Codec for a new decoder session. Slice mode needs the native decoder's support for partial access units.
+// Decoders calibration times and the Decoder list offers
+static bool backend_eligible(const AVCodec *codec) {
+    return codec->id == AV_CODEC_ID_H264 && av_codec_is_decoder(codec) && !(codec->capabilities & AV_CODEC_CAP_EXPERIMENTAL);
+}
+
+static const AVCodec *backend_codec(struct ocam_device *dev, bool chunked) {
+    const AVCodec *codec = NULL;
+    if (chunked) return avcodec_find_decoder(AV_CODEC_ID_H264);
+
+    char name[32];
+    pthread_mutex_lock(&dev->mutex);
+    snprintf(name, sizeof(name), "%s", dev->backend_name);
+    const AVCodec *rejected = dev->backend_rejected;
+    pthread_mutex_unlock(&dev->mutex);
+
+    if (!*name) {
+        pthread_mutex_lock(&backend_cache.mutex);
+        backend_cache_load();
+        const struct backend_calibration *c = backend_cache_find((int)dev->width, (int)dev->height);
+        if (c) snprintf(name, sizeof(name), "%s", c->selected);
+        pthread_mutex_unlock(&backend_cache.mutex);
     }
 
-    bool flash = obs_data_get_bool(settings, "flash");
-    if (flash != s->current_flash) {
-        send_control_command(s, 0x09, flash ? 1 : 0, 0);
-        s->current_flash = flash;
+    if (*name) codec = avcodec_find_decoder_by_name(name);
+    if (codec && (codec == rejected || !backend_eligible(codec))) codec = NULL;
+    return codec ? codec : avcodec_find_decoder(AV_CODEC_ID_H264);
+}
+
+// Worker: makes backend_changed look the backend up again at the next access unit
+static void backend_recheck(struct ocam_device *dev) {
+    dev->backend_generation = os_atomic_load_long(&backend_cache.generation) - 1;
+}
+
+// The live backend outputs pictures OBS cannot take: use the built-in decoder until the setting changes
+static void backend_reject(struct ocam_device *dev, const AVCodec *codec, int format) {
+    pthread_mutex_lock(&dev->mutex);
+    bool first = dev->backend_rejected != codec;
+    dev->backend_rejected = codec;
+    pthread_mutex_unlock(&dev->mutex);
+    if (!first) return;
+
+    blog(LOG_WARNING, "[OCAM] Decoder '%s' outputs unsupported pixel format %d; falling back to the built-in decoder",
+         codec->name, format);
+    backend_recheck(dev);
+}
+
+// True once after a calibration or setting change picks a different codec for this session
+static bool backend_changed(struct ocam_device *dev, const struct ocam_decoder *d, bool chunked) {
+    long generation = os_atomic_load_long(&backend_cache.generation);
+    if (generation == dev->backend_generation) return false;
+    dev->backend_generation = generation;
+    return backend_codec(dev, chunked) != d->codec;
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void benchmark_backend(const AVCodec *codec, const struct calibration_clip *clip, struct backend_result *r) {
+    AVCodecContext *ctx = avcodec_alloc_context3(codec);
+    AVPacket *packet = av_packet_alloc();
+    AVFrame *frame = av_frame_alloc();
+
+    size_t passes = CALIBRATION_TARGET_DECODES / clip->count + 1;
+    if (passes > CALIBRATION_MAX_PASSES) passes = CALIBRATION_MAX_PASSES;
+    uint64_t *times = bzalloc(sizeof(uint64_t) * clip->count * passes);
+    size_t timed = 0;
+    int pictures = 0;
+    bool usable = true;
+
+    if (!ctx || !packet || !frame) goto done;
+    if (clip->extradata_size > 0) {
+        ctx->extradata = (uint8_t*)av_mallocz(clip->extradata_size + AV_INPUT_BUFFER_PADDING_SIZE);
+        memcpy(ctx->extradata, clip->extradata, clip->extradata_size);
+        ctx->extradata_size = clip->extradata_size;
     }
+    decoder_configure(ctx, false);  // Backends only run frame-mode sessions
+    if (avcodec_open2(ctx, codec, NULL) < 0) goto done;
+
+    for (size_t pass = 0; pass < passes; pass++) {
+        for (size_t i = 0; i < clip->count; i++) {
+            const struct gop_entry *u = &clip->units[i];
+            packet->data = clip->data + u->offset;
+            packet->size = u->size;
+            packet->pts = (int64_t)i;
+
+            uint64_t start = os_gettime_ns();
+            if (avcodec_send_packet(ctx, packet) < 0) continue;
+            while (avcodec_receive_frame(ctx, frame) >= 0) {
+                if (convert_pixel_format(frame->format) == VIDEO_FORMAT_NONE) usable = false;
+                if (frame->pts >= 0 && frame->pts <= (int64_t)i && (int)(i - frame->pts) > r->delay_frames)
+                    r->delay_frames = (int)(i - frame->pts);
+                pictures++;
+                av_frame_unref(frame);
+            }
+            times[timed++] = os_gettime_ns() - start;
+        }
 
-    int iso = (int)obs_data_get_int(settings, "iso");
-    if (iso != s->current_iso) {
-        send_control_command(s, 0x06, iso, 0);
-        s->current_iso = iso;
+        // Drain, then start the next pass from the IDR again
+        avcodec_send_packet(ctx, NULL);
+        while (avcodec_receive_frame(ctx, frame) >= 0) {
+            pictures++;
+            av_frame_unref(frame);
+        }
+        avcodec_flush_buffers(ctx);
+    }
+    packet->data = NULL;
+    packet->size = 0;
+
+    if (timed && pictures && usable) {
+        uint64_t total = 0;
+        for (size_t i = 0; i < timed; i++) total += times[i];
+        qsort(times, timed, sizeof(uint64_t), compare_u64);
+        r->avg_ms = total / (double)timed / 1e6;
+        r->p95_ms = times[timed * 95 / 100 < timed ? timed * 95 / 100 : timed - 1] / 1e6;
+        r->ok = true;
     }
 
-    int exp = (int)obs_data_get_int(settings, "exposure");
-    if (exp != s->current_exp) {
-        send_control_command(s, 0x07, exp, 0);
-        s->current_exp = exp;
+done:
+    bfree(times);
+    if (frame) av_frame_free(&frame);
+    if (packet) av_packet_free(&packet);
+    if (ctx) avcodec_free_context(&ctx);
+}
+
+static void calibration_clip_free(struct calibration_clip *clip) {
+    bfree(clip->extradata);
+    bfree(clip->data);
+    bfree(clip->units);
+    bfree(clip);
+}
+
+static void *calibration_thread_func(void *data) {
+    struct calibration_clip *clip = data;
+    struct thread_slot *thread = thread_policy_enter(STAGE_BACKGROUND, "ocam-calib");
+    struct backend_calibration c = {0};
+    c.width = clip->width;
+    c.height = clip->height;
+    c.budget_ms = clip->interval_ms;
+
+    double best_ms = 0.0;
+    void *it = NULL;
+    const AVCodec *codec;
+    while ((codec = av_codec_iterate(&it)) && c.result_count < BACKEND_MAX) {
+        if (!backend_eligible(codec)) continue;
+
+        struct backend_result *r = &c.results[c.result_count++];
+        snprintf(r->name, sizeof(r->name), "%s", codec->name);
+        benchmark_backend(codec, clip, r);
+        r->in_budget = r->ok && r->delay_frames == 0 && r->p95_ms <= c.budget_ms;
+        if (r->in_budget && (!*c.selected || r->avg_ms < best_ms)) {
+            snprintf(c.selected, sizeof(c.selected), "%s", r->name);
+            best_ms = r->avg_ms;
+        }
+
+        if (r->ok)
+            blog(LOG_INFO, "[OCAM] Decoder '%s': avg %.2f ms, p95 %.2f ms, holds %d frames%s", r->name, r->avg_ms, r->p95_ms,
+                 r->delay_frames, r->in_budget ? "" : " (over budget)");
+        else
+            blog(LOG_INFO, "[OCAM] Decoder '%s': unusable", r->name);
     }
+    blog(LOG_INFO, "[OCAM] Decoder calibration %dx%d (budget %.2f ms): using %s", c.width, c.height, c.budget_ms,
+         *c.selected ? c.selected : "native decoder");
+
+    pthread_mutex_lock(&backend_cache.mutex);
+    struct backend_calibration *slot = backend_cache_find(c.width, c.height);
+    if (!slot) {
+        if (backend_cache.count == BACKEND_CACHE_MAX) {
+            memmove(backend_cache.entries, backend_cache.entries + 1, sizeof(c) * (BACKEND_CACHE_MAX - 1));
+            backend_cache.count--;
+        }
+        slot = &backend_cache.entries[backend_cache.count++];
+    }
+    *slot = c;
+    backend_cache_save();
+    backend_cache.running = false;
+    pthread_mutex_unlock(&backend_cache.mutex);
+
+    os_atomic_inc_long(&backend_cache.generation);
+    calibration_clip_free(clip);
+    thread_policy_exit(thread);
+    return NULL;
+}
 
-    int focus = (int)obs_data_get_int(settings, "focus");
-    if (focus != s->current_focus) {
-        send_control_command(s, 0x08, focus, 0);
-        s->current_focus = focus;
+// Called by the decode worker when a new IDR arrives: entries [0, end) hold the GOP it ends
+static void calibration_start(struct ocam_device *dev, size_t end) {
+    const struct gop_cache *g = &dev->gop;
+    if (!g->valid || end == 0 || !dev->width || !dev->height) return;
+
+    pthread_mutex_lock(&backend_cache.mutex);
+    backend_cache_load();
+    bool wanted = !backend_cache.running && !backend_cache_find((int)dev->width, (int)dev->height);
+    if (wanted) {
+        // A finished calibration thread is joined before the next one starts
+        if (backend_cache.thread_active) pthread_join(backend_cache.thread, NULL);
+        backend_cache.thread_active = false;
+    }
+    pthread_mutex_unlock(&backend_cache.mutex);
+    if (!wanted) return;
+
+    // Slices of one picture share a pts; padding between them is valid Annex B zero bytes
+    size_t units = 0;
+    for (size_t i = 0; i < end; i++)
+        if (i == 0 || g->entries[i].pts != g->entries[i - 1].pts) units++;
+    if (units < CALIBRATION_MIN_FRAMES) return;
+
+    struct calibration_clip *clip = bzalloc(sizeof(*clip));
+    clip->width = (int)dev->width;
+    clip->height = (int)dev->height;
+    clip->units = bzalloc(sizeof(struct gop_entry) * units);
+    for (size_t i = 0; i < end; i++) {
+        const struct gop_entry *e = &g->entries[i];
+        if (i == 0 || e->pts != g->entries[i - 1].pts) clip->units[clip->count++] = *e;
+        struct gop_entry *u = &clip->units[clip->count - 1];
+        u->size = (int)(e->offset + e->size - u->offset);
     }
+    size_t data_size = g->entries[end - 1].offset + g->entries[end - 1].size + AV_INPUT_BUFFER_PADDING_SIZE;
+    clip->data = bmemdup(g->data, data_size);
+    if (dev->extradata_size > 0) {
+        clip->extradata = bmemdup(dev->extradata, dev->extradata_size);
+        clip->extradata_size = dev->extradata_size;
+    }
+    int64_t span_us = clip->units[clip->count - 1].pts - clip->units[0].pts;
+    clip->interval_ms = span_us > 0 ? span_us / 1000.0 / (double)(clip->count - 1) : 1000.0 / 60.0;
+
+    blog(LOG_INFO, "[OCAM] Calibrating decoders on %zu frames at %dx%d...", clip->count, clip->width, clip->height);
+    pthread_mutex_lock(&backend_cache.mutex);
+    bool started = pthread_create(&backend_cache.thread, NULL, calibration_thread_func, clip) == 0;
+    backend_cache.running = backend_cache.thread_active = started;
+    pthread_mutex_unlock(&backend_cache.mutex);
+    if (!started) calibration_clip_free(clip);
 }
 
-// --- Video FFmpeg Utils ---
+// Drops the cached result so the next GOP at this size is measured again
+static void backend_forget(int width, int height) {
+    pthread_mutex_lock(&backend_cache.mutex);
+    backend_cache_load();
+    struct backend_calibration *c = backend_cache_find(width, height);
+    if (c) {
+        size_t index = (size_t)(c - backend_cache.entries);
+        memmove(c, c + 1, sizeof(*c) * (backend_cache.count - index - 1));
+        backend_cache.count--;
+        backend_cache_save();
+    }
+    pthread_mutex_unlock(&backend_cache.mutex);
+}
 
-static inline enum video_format convert_pixel_format(int f) {
-    switch (f) {
-        case AV_PIX_FMT_YUV420P: return VIDEO_FORMAT_I420;
-        case AV_PIX_FMT_YUVJ420P: return VIDEO_FORMAT_I420;
-        case AV_PIX_FMT_NV12: return VIDEO_FORMAT_NV12;
-        default: return VIDEO_FORMAT_NONE;
+// One line for the properties: the live session's backend and the measurements behind the choice.
+// Caller holds dev->mutex.
+static void backend_describe(struct ocam_device *dev, struct dstr *info) {
+    const AVCodec *live = dev->decoder.codec;
+    dstr_printf(info, "Decoder: %s (%s)", live ? live->name : "none", *dev->backend_name ? "manual" : "auto");
+    if (dev->backend_rejected) dstr_catf(info, " | %s output unsupported pictures", dev->backend_rejected->name);
+
+    pthread_mutex_lock(&backend_cache.mutex);
+    backend_cache_load();
+    const struct backend_calibration *c = backend_cache_find((int)dev->width, (int)dev->height);
+    if (c) {
+        dstr_catf(info, " | %dx%d, budget %.2f ms:", c->width, c->height, c->budget_ms);
+        for (int i = 0; i < c->result_count; i++) {
+            const struct backend_result *r = &c->results[i];
+            if (!r->ok) {
+                dstr_catf(info, "%s %s unusable", i ? "," : "", r->name);
+                continue;
+            }
+            dstr_catf(info, "%s %s avg %.2f / p95 %.2f ms", i ? "," : "", r->name, r->avg_ms, r->p95_ms);
+            if (r->delay_frames) dstr_catf(info, ", holds %d frames", r->delay_frames);
+            if (!r->in_budget) dstr_cat(info, " (over budget)");
+        }
+    } else {
+        dstr_cat(info, backend_cache.running ? " | Calibrating..." : " | Not calibrated at this resolution yet");
     }
+    pthread_mutex_unlock(&backend_cache.mutex);
 }
 
-static inline enum video_colorspace convert_color_space(enum AVColorSpace s) {
-    switch (s) {
-        case AVCOL_SPC_BT709: return VIDEO_CS_709;
-        case AVCOL_SPC_SMPTE170M: return VIDEO_CS_601;
-        default: return VIDEO_CS_DEFAULT;
+// --- H.264 Bitstream Helpers ---
+
+#define NAL_NOT_FOUND ((size_t)-1)
+
+// Offset of the next Annex B start code (00 00 01 or 00 00 00 01) in [from, end)
+static size_t find_start_code(const uint8_t *buf, size_t from, size_t end) {
+    for (size_t i = from; i + 3 <= end; i++) {
+        if (buf[i] == 0 && buf[i + 1] == 0 && buf[i + 2] == 1) {
+            return (i > from && buf[i - 1] == 0) ? i - 1 : i;
+        }
     }
+    return NAL_NOT_FOUND;
 }
 
-static void cleanup_ffmpeg(struct ocam_source *s) {
-    if (s->codec_ctx) { avcodec_free_context(&s->codec_ctx); s->codec_ctx = NULL; }
-    if (s->decoded_frame) { av_frame_free(&s->decoded_frame); s->decoded_frame = NULL; }
-    if (s->extradata) { free(s->extradata); s->extradata = NULL; }
-    s->extradata_size = 0;
-    s->codec_initialized = false;
+// NAL unit type of a buffer starting with a start code, -1 if there is none
+static int nal_unit_type(const uint8_t *buf, size_t size) {
+    size_t i = 0;
+    while (i < size && buf[i] == 0) i++;
+    if (i < 2 || i + 1 >= size || buf[i] != 1) return -1;
+    return buf[i + 1] & 0x1F;
 }
 
-static bool init_ffmpeg(struct ocam_source *s) {
-    const AVCodec *codec = avcodec_find_decoder(AV_CODEC_ID_H264);
-    if (!codec) return false;
+// NAL unit type of the first slice in an access unit, -1 if none is found
+static int first_slice_type(const uint8_t *buf, size_t size) {
+    size_t pos = find_start_code(buf, 0, size);
+    while (pos != NAL_NOT_FOUND) {
+        int type = nal_unit_type(buf + pos, size - pos);
+        if (type >= 1 && type <= 5) return type;
+        pos = find_start_code(buf, pos + 3, size);
+    }
+    return -1;
+}
+
+// Bytes before the first slice NAL unit: the parameter sets a config packet carries.
+// The whole buffer if it has no slice.
+static size_t config_prefix_size(const uint8_t *buf, size_t size) {
+    size_t pos = find_start_code(buf, 0, size);
+    while (pos != NAL_NOT_FOUND) {
+        int type = nal_unit_type(buf + pos, size - pos);
+        if (type >= 1 && type <= 5) return pos;
+        pos = find_start_code(buf, pos + 3, size);
+    }
+    return size;
+}
+
+// --- GOP Cache ---
+
+static void gop_cache_clear(struct gop_cache *g) {
+    g->size = g->count = g->au_start = 0;
+    g->valid = g->au_idr = false;
+}
+
+static void gop_cache_free(struct gop_cache *g) {
+    bfree(g->data);
+    bfree(g->entries);
+    memset(g, 0, sizeof(*g));
+}
+
+// Drops the entries before first (the access unit a new IDR belongs to)
+static void gop_cache_trim(struct gop_cache *g, size_t first) {
+    if (first == 0) return;
+    size_t base = first < g->count ? g->entries[first].offset : g->size;
+    memmove(g->data, g->data + base, g->size - base);
+    g->size -= base;
+    g->count -= first;
+    memmove(g->entries, g->entries + first, g->count * sizeof(*g->entries));
+    for (size_t i = 0; i < g->count; i++) g->entries[i].offset -= base;
+}
+
+static void gop_cache_add(struct gop_cache *g, struct decode_job *job, int nal_type) {
+    const AVPacket *packet = job->packet;
+    bool chunked = job->type == DECODE_JOB_SLICE;
+
+    if (!chunked || job->first_slice) {
+        if (g->valid && chunked != g->chunked) g->valid = false;
+        // Without a GOP to extend, only the access unit now arriving is worth keeping
+        if (!g->valid) g->size = g->count = 0;
+        g->au_start = g->count;
+        g->au_idr = false;
+    }
+
+    if (nal_type == 5 && !g->au_idr) {
+        gop_cache_trim(g, g->au_start);
+        g->au_start = 0;
+        g->au_idr = true;
+        g->valid = true;
+        g->chunked = chunked;
+    }
+
+    size_t need = g->size + (size_t)packet->size + AV_INPUT_BUFFER_PADDING_SIZE;
+    if (need > GOP_CACHE_MAX_BYTES) {
+        // Keyframe interval too long for the cache: wait for the next IDR
+        gop_cache_clear(g);
+        return;
+    }
+    if (need > g->capacity) {
+        size_t capacity = g->capacity ? g->capacity : 1024 * 1024;
+        while (capacity < need) capacity *= 2;
+        g->data = brealloc(g->data, capacity);
+        g->capacity = capacity;
+    }
+    if (g->count == g->entries_capacity) {
+        g->entries_capacity = g->entries_capacity ? g->entries_capacity * 2 : 256;
+        g->entries = brealloc(g->entries, g->entries_capacity * sizeof(*g->entries));
+    }
+
+    struct gop_entry *e = &g->entries[g->count++];
+    e->offset = g->size;
+    e->size = packet->size;
+    e->pts = packet->pts;
+    e->nal_type = nal_type;
+    memcpy(g->data + g->size, packet->data, (size_t)packet->size);
+    memset(g->data + g->size + packet->size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+    g->size = need;
+}
+
+// --- Presentation ---
+// Pictures reach OBS either straight from the decoder or through the pacer, which
+// holds them for a jitter window and releases them on the cadence their pts
+// describe. Bursty USB/Wi-Fi arrival then no longer shows up as doubled and
+// skipped frames.
+
+static bool frame_to_obs(const AVFrame *frame, uint64_t timestamp, struct obs_source_frame *out) {
+    enum video_format obs_fmt = convert_pixel_format(frame->format);
+    if (obs_fmt == VIDEO_FORMAT_NONE) return false;
+
+    struct obs_source_frame obs_frame = {0};
+    for (int i = 0; i < MAX_AV_PLANES; i++) {
+        obs_frame.data[i] = frame->data[i];
+        obs_frame.linesize[i] = abs(frame->linesize[i]);
+    }
+    obs_frame.format = obs_fmt;
+    obs_frame.width = frame->width;
+    obs_frame.height = frame->height;
+    obs_frame.full_range = (frame->color_range == AVCOL_RANGE_JPEG);
+    obs_frame.timestamp = timestamp;
+
+    enum video_colorspace cs = convert_color_space(frame->colorspace);
+    video_format_get_parameters_for_format(cs, frame->color_range == AVCOL_RANGE_JPEG ? VIDEO_RANGE_FULL : VIDEO_RANGE_PARTIAL,
+                                           obs_fmt, obs_frame.color_matrix, obs_frame.color_range_min, obs_frame.color_range_max);
+    *out = obs_frame;
+    return true;
+}
+
+// Hands the latest picture to every subscriber (or just one). Every source reads
+// the same decoder buffers; nothing is copied before OBS takes the frame.
+static void deliver_last_frame(struct ocam_device *dev, struct ocam_source *only) {
+    struct obs_source_frame obs_frame;
+    if (!dev->last_frame->buf[0] || !frame_to_obs(dev->last_frame, dev->last_frame_ts, &obs_frame)) return;
+
+    for (struct ocam_source *sub = only ? only : dev->subscribers; sub; sub = only ? NULL : sub->next) {
+        sub->width = obs_frame.width;
+        sub->height = obs_frame.height;
+        obs_source_output_video(sub->source, &obs_frame);
+    }
+}
+
+// Makes frame (a reference the caller gives up) the current picture and shows it everywhere
+static void present_frame(struct ocam_device *dev, AVFrame *frame, uint64_t timestamp) {
+    pthread_mutex_lock(&dev->sub_mutex);
+    av_frame_unref(dev->last_frame);
+    av_frame_move_ref(dev->last_frame, frame);
+    dev->last_frame_ts = timestamp;
+    deliver_last_frame(dev, NULL);
+    pthread_mutex_unlock(&dev->sub_mutex);
+
+    struct cadence_stats present;
+    if (cadence_tick(&dev->present_window, os_gettime_ns(), &present)) {
+        pthread_mutex_lock(&dev->mutex);
+        dev->present_stats = present;
+        pthread_mutex_unlock(&dev->mutex);
+    }
+}
+
+// Buffered, OBS lines video and audio up by timestamp. Unbuffered, it shows each
+// picture on arrival, window_ns after its timestamp, so audio is stamped that much later too.
+static void apply_async_mode(struct ocam_device *dev, bool unbuffered, int64_t window_ns) {
+    os_atomic_store_long(&dev->audio_delay_ns, unbuffered ? (long)window_ns : 0);
+
+    pthread_mutex_lock(&dev->sub_mutex);
+    if (unbuffered != dev->async_unbuffered) {
+        dev->async_unbuffered = unbuffered;
+        for (struct ocam_source *sub = dev->subscribers; sub; sub = sub->next)
+            obs_source_set_async_unbuffered(sub->source, unbuffered);
+        blog(LOG_INFO, "[OCAM] '%s': OBS %s mode", dev->name, unbuffered ? "unbuffered" : "buffered");
+    }
+    pthread_mutex_unlock(&dev->sub_mutex);
+}
+
+static void pacer_init(struct pacer *p) {
+    memset(p, 0, sizeof(*p));
+    pthread_mutex_init(&p->mutex, NULL);
+    pthread_cond_init(&p->cond, NULL);
+    for (int i = 0; i < PACER_MAX_FRAMES; i++) p->frames[i].frame = av_frame_alloc();
+    p->min_slack_ns = INT64_MAX;
+}
+
+static void pacer_free(struct pacer *p) {
+    for (int i = 0; i < PACER_MAX_FRAMES; i++) av_frame_free(&p->frames[i].frame);
+    pthread_cond_destroy(&p->cond);
+    pthread_mutex_destroy(&p->mutex);
+}
+
+// Decode worker: queues a picture for its slot on the pts timeline. The pts-derived
+// timestamp goes to OBS unchanged; only the release time follows the window.
+// Returns false when pacing is off and nothing is waiting, so the caller shows it directly.
+static bool pacer_push(struct pacer *p, AVFrame *frame, int64_t pts_ns) {
+    int64_t now = (int64_t)os_gettime_ns();
+    pthread_mutex_lock(&p->mutex);
+    if (p->window_ns == 0 && p->count == 0) {
+        p->anchored = false;
+        pthread_mutex_unlock(&p->mutex);
+        return false;
+    }
+
+    // First picture, stream restart or a jump in pts: start a new timeline
+    if (!p->anchored || pts_ns <= p->last_pts_ns || pts_ns - p->last_pts_ns > PACER_RESYNC_NS) {
+        p->anchor_ns = now + p->window_ns;
+        p->pts_base_ns = pts_ns;
+        p->anchored = true;
+    }
+    p->last_pts_ns = pts_ns;
+
+    int64_t target = p->anchor_ns + (pts_ns - p->pts_base_ns);
+    if (target < now) {
+        // Arrived after its slot: the rest of the timeline moves back with it
+        p->anchor_ns += now - target;
+        target = now;
+        p->late++;
+    }
+    if (target - now < p->min_slack_ns) p->min_slack_ns = target - now;
+
+    if (p->count == PACER_MAX_FRAMES) {
+        av_frame_unref(p->frames[p->head].frame);
+        p->head = (p->head + 1) % PACER_MAX_FRAMES;
+        p->count--;
+        p->dropped++;
+    }
+    struct pacer_frame *f = &p->frames[(p->head + p->count) % PACER_MAX_FRAMES];
+    if (av_frame_ref(f->frame, frame) == 0) {
+        f->target_ns = target;
+        f->timestamp_ns = pts_ns;
+        p->count++;
+        pthread_cond_signal(&p->cond);
+    }
+    pthread_mutex_unlock(&p->mutex);
+    return true;
+}
+
+// Once per cadence window: resize the jitter window and, if every picture had
+// more slack than it needed, pull the timeline in to shed the extra latency
+static void pacer_retune(struct pacer *p, int64_t window_ns) {
+    pthread_mutex_lock(&p->mutex);
+    if (p->anchored) {
+        int64_t shift = window_ns - p->window_ns;
+        int64_t excess = p->min_slack_ns != INT64_MAX ? p->min_slack_ns - p->window_ns : 0;
+        if (excess > PACER_SLACK_TOLERANCE_NS) shift -= excess / 2;
+        p->anchor_ns += shift;
+    }
+    p->window_ns = window_ns;
+    p->min_slack_ns = INT64_MAX;
+    pthread_mutex_unlock(&p->mutex);
+}
+
+// Auto window: cover the worst late gap seen at ingest, within a few frames
+static int64_t pacer_auto_window(const struct cadence_stats *ingest, int64_t current_ns) {
+    if (!cadence_current(ingest) || ingest->interval_ms <= 0.0) return 0;
+
+    double interval_ns = ingest->interval_ms * 1e6;
+    double target = ingest->max_interval_ms * 1e6 - interval_ns;
+    if (target < interval_ns * 0.25) target = 0.0;
+    if (target > interval_ns * PACER_MAX_WINDOW_FRAMES) target = interval_ns * PACER_MAX_WINDOW_FRAMES;
+    if (target > PACER_MAX_WINDOW_MS * 1e6) target = PACER_MAX_WINDOW_MS * 1e6;
+
+    // Grow at once, shrink gradually so one calm window does not undo it
+    if (target < current_ns) target = current_ns - (current_ns - target) / 4;
+    return (int64_t)target;
+}
+
+// Decode worker, once per cadence window: pick the jitter window and the OBS async mode
+static void pacer_update(struct ocam_device *dev, const struct cadence_stats *ingest) {
+    int setting = dev->jitter_window_ms;
+    int64_t window_ns;
+    if (setting < 0) window_ns = pacer_auto_window(ingest, dev->pacer.window_ns);
+    else window_ns = (int64_t)(setting < PACER_MAX_WINDOW_MS ? setting : PACER_MAX_WINDOW_MS) * 1000000;
+    pacer_retune(&dev->pacer, window_ns);
+
+    // Gaps the window cannot cover are left to OBS's own timestamp buffering; Off always means unbuffered
+    bool unbuffered = true;
+    if (setting < 0 && cadence_current(ingest)) {
+        double gap_ns = (ingest->max_interval_ms - ingest->interval_ms) * 1e6;
+        unbuffered = gap_ns <= (double)window_ns + ingest->interval_ms * 0.25e6;
+    }
+    apply_async_mode(dev, unbuffered, window_ns);
+}
+
+static void *pacer_thread_func(void *data) {
+    struct ocam_device *dev = data;
+    struct pacer *p = &dev->pacer;
+    AVFrame *frame = av_frame_alloc();
+
+    char name[16];
+    snprintf(name, sizeof(name), "ocam-pace-%d", dev->port);
+    struct thread_slot *slot = thread_policy_enter(STAGE_PRESENT, name);
+
+    pthread_mutex_lock(&p->mutex);
+    while (dev->thread_running && frame) {
+        if (!p->count) {
+            pthread_cond_wait(&p->cond, &p->mutex);
+            continue;
+        }
+
+        uint64_t target = (uint64_t)p->frames[p->head].target_ns;
+        if (os_gettime_ns() < target) {
+            pthread_mutex_unlock(&p->mutex);
+            os_sleepto_ns(target);
+            pthread_mutex_lock(&p->mutex);
+            continue;
+        }
+
+        uint64_t timestamp = (uint64_t)p->frames[p->head].timestamp_ns;
+        av_frame_move_ref(frame, p->frames[p->head].frame);
+        p->head = (p->head + 1) % PACER_MAX_FRAMES;
+        p->count--;
+        pthread_mutex_unlock(&p->mutex);
+
+        present_frame(dev, frame, timestamp);
+        thread_policy_tick(slot);
+
+        pthread_mutex_lock(&p->mutex);
+    }
+    pthread_mutex_unlock(&p->mutex);
+    av_frame_free(&frame);
+    thread_policy_exit(slot);
+    return NULL;
+}
+
+// --- Video Decode (runs on the shared decode pool) ---
+
+#define PENDING_KEYFRAME_RETRY 60
+
+static void output_frame(struct ocam_device *dev, AVFrame *frame, int64_t pts_ns) {
+    if (convert_pixel_format(frame->format) == VIDEO_FORMAT_NONE) {
+        // A manually chosen backend may not output a format OBS takes; the built-in one always does
+        const AVCodec *live = dev->decoder.codec;
+        if (live && live != avcodec_find_decoder(AV_CODEC_ID_H264)) backend_reject(dev, live, frame->format);
+        return;
+    }
+
+    if ((uint32_t)frame->width != dev->width || (uint32_t)frame->height != dev->height) {
+        dev->width = (uint32_t)frame->width;
+        dev->height = (uint32_t)frame->height;
+        // The backend was picked before the size was known (first connect) or for the old size
+        backend_recheck(dev);
+    }
+
+    uint64_t timestamp = (uint64_t)(pts_ns + dev->timestamp_offset);
+    if (dev->replaying) {
+        // Catching up: keep the picture for the end of the replay, show nothing yet
+        pthread_mutex_lock(&dev->sub_mutex);
+        av_frame_unref(dev->last_frame);
+        if (av_frame_ref(dev->last_frame, frame) == 0) dev->last_frame_ts = timestamp;
+        pthread_mutex_unlock(&dev->sub_mutex);
+        return;
+    }
+
+    if (!pacer_push(&dev->pacer, frame, (int64_t)timestamp)) {
+        av_frame_ref(dev->direct_frame, frame);
+        present_frame(dev, dev->direct_frame, timestamp);
+    }
+
+    struct cadence_stats output;
+    if (cadence_tick(&dev->output_window, os_gettime_ns(), &output)) {
+        pthread_mutex_lock(&dev->mutex);
+        dev->output_stats = output;
+        struct cadence_stats ingest = dev->ingest_stats;
+        struct cadence_stats present = dev->present_stats;
+        pthread_mutex_unlock(&dev->mutex);
+
+        pacer_update(dev, &ingest);
+
+        if (++dev->cadence_windows % 15 == 0) {
+            pthread_mutex_lock(&dev->pacer.mutex);
+            uint32_t late = dev->pacer.late, dropped = dev->pacer.dropped;
+            dev->pacer.late = dev->pacer.dropped = 0;
+            pthread_mutex_unlock(&dev->pacer.mutex);
+
+            blog(LOG_INFO, "[OCAM] Cadence '%s': ingest %.1f fps (jitter %.2f ms, max gap %.2f ms), decoded %.1f fps (jitter %.2f ms, max gap %.2f ms), "
+                 "presented %.1f fps (jitter %.2f ms, max gap %.2f ms), window %.1f ms, %u late, %u dropped",
+                 dev->name, ingest.fps, ingest.jitter_ms, ingest.max_interval_ms,
+                 output.fps, output.jitter_ms, output.max_interval_ms,
+                 present.fps, present.jitter_ms, present.max_interval_ms,
+                 dev->pacer.window_ns / 1e6, late, dropped);
+        }
+    }
+}
+
+// Sends one packet (a whole access unit, a single NAL unit, or NULL to drain) and outputs every finished picture
+static int decode_and_output(struct ocam_device *dev, struct ocam_decoder *dec, AVPacket *packet) {
+    int frames = 0;
+    if (avcodec_send_packet(dec->ctx, packet) < 0) return 0;
+
+    while (avcodec_receive_frame(dec->ctx, dec->frame) >= 0) {
+        if (dec == &dev->pending) {
+            // Nothing from the new stream is shown until it decodes cleanly
+            if (!frame_is_clean_keyframe(dec->frame)) continue;
+            swap_in_pending(dev);
+            dec = &dev->decoder;
+        }
+        if (!dev->last_picture_ns) dev->last_picture_ns = os_gettime_ns();
+
+        output_frame(dev, dec->frame, dec->frame->pts * 1000);
+        frames++;
+    }
+    return frames;
+}
+
+// Brings a fresh decoder up to the newest cached picture and shows only that one
+static int gop_cache_replay(struct ocam_device *dev) {
+    struct gop_cache *g = &dev->gop;
+    decoder_close(&dev->decoder);
+    decoder_close(&dev->pending);
+
+    if (!g->valid || !g->count) {
+        send_control_command(dev, 0x04, 0, 0);
+        return 0;
+    }
+    if (!dev->replay_packet && !(dev->replay_packet = av_packet_alloc())) return 0;
+    if (!decoder_open(dev, &dev->decoder, g->chunked, backend_codec(dev, g->chunked))) return 0;
+
+    uint64_t start = os_gettime_ns();
+    AVPacket *packet = dev->replay_packet;
+    int frames = 0;
+
+    dev->replaying = true;
+    for (size_t i = 0; i < g->count; i++) {
+        const struct gop_entry *e = &g->entries[i];
+        packet->data = g->data + e->offset;
+        packet->size = e->size;
+        packet->pts = e->pts;
+        if (decoder_accepts(&dev->decoder, e->nal_type)) frames += decode_and_output(dev, &dev->decoder, packet);
+    }
+    dev->replaying = false;
+    packet->data = NULL;
+    packet->size = 0;
+
+    if (frames > 0) {
+        pthread_mutex_lock(&dev->sub_mutex);
+        deliver_last_frame(dev, NULL);
+        pthread_mutex_unlock(&dev->sub_mutex);
+    }
+    blog(LOG_INFO, "[OCAM] '%s': caught up from %zu cached packets in %.1f ms.", dev->name, g->count,
+         (os_gettime_ns() - start) / 1e6);
+    return frames;
+}
+
+static void record_keyframe_latency(struct ocam_device *dev, uint32_t size, uint64_t recv_start, uint64_t recv_end, uint64_t overlap_ns) {
+    if (!dev->last_picture_ns) return;
+
+    // Averages are per decode mode
+    if (dev->kf_chunked != dev->decoder.chunked) {
+        dev->kf_chunked = dev->decoder.chunked;
+        dev->kf_count = 0;
+        dev->kf_bytes_total = dev->kf_recv_ns_total = dev->kf_picture_ns_total = 0;
+        dev->kf_tail_ns_total = dev->kf_overlap_ns_total = 0;
+    }
+
+    dev->kf_count++;
+    dev->kf_bytes_total += size;
+    dev->kf_recv_ns_total += recv_end - recv_start;
+    dev->kf_picture_ns_total += dev->last_picture_ns - recv_start;
+    dev->kf_tail_ns_total += (dev->last_picture_ns > recv_end) ? dev->last_picture_ns - recv_end : 0;
+    dev->kf_overlap_ns_total += overlap_ns;
+
+    if (dev->kf_count % 10 == 0) {
+        double n = (double)dev->kf_count;
+        blog(LOG_INFO, "[OCAM] Keyframe latency (%s decode, %u keyframes): avg %.0f KB, receive %.2f ms, "
+             "receive-to-picture %.2f ms, last byte-to-picture %.2f ms, decode overlapped with receive %.2f ms",
+             dev->kf_chunked ? "slice" : "frame", dev->kf_count, dev->kf_bytes_total / n / 1024.0,
+             dev->kf_recv_ns_total / n / 1e6, dev->kf_picture_ns_total / n / 1e6,
+             dev->kf_tail_ns_total / n / 1e6, dev->kf_overlap_ns_total / n / 1e6);
+    }
+}
+
+// Stream bookkeeping every access unit needs, decoded or not
+static void note_access_unit(struct ocam_device *dev, struct decode_job *job) {
+    if (!dev->first_frame_received) {
+        dev->timestamp_offset = (int64_t)job->recv_start_ns - job->pts_ns;
+        dev->first_frame_received = true;
+    }
+    dev->config_open = false;
+}
+
+// First packet of an access unit: make sure a decoder in the job's mode will take it and set up timing
+static struct ocam_decoder *begin_access_unit(struct ocam_device *dev, struct decode_job *job) {
+    bool chunked = job->type == DECODE_JOB_SLICE;
+    struct ocam_decoder *in = input_decoder(dev);
+
+    if (!in->ctx) {
+        if (!decoder_open(dev, &dev->decoder, chunked, backend_codec(dev, chunked))) return NULL;
+    } else if (in->chunked != chunked || backend_changed(dev, in, chunked)) {
+        // Decode mode or backend changed: warm up a new decoder while the live one keeps its picture
+        decoder_close(&dev->pending);
+        if (!decoder_open(dev, &dev->pending, chunked, backend_codec(dev, chunked))) return NULL;
+        send_control_command(dev, 0x04, 0, 0);
+    }
+    in = input_decoder(dev);
+
+    // The new stream has not produced a picture yet: ask the phone for an IDR
+    if (++in->access_units % PENDING_KEYFRAME_RETRY == 0 && in == &dev->pending) send_control_command(dev, 0x04, 0, 0);
+
+    note_access_unit(dev, job);
+    dev->last_picture_ns = 0;
+    dev->au_keyframe = false;
+    dev->au_overlap_ns = 0;
+    dev->au_slice_done_ns = 0;
+    return in;
+}
+
+static int decode_frame_job(struct ocam_device *dev, struct decode_job *job) {
+    AVPacket *packet = job->packet;
+    int slice_type = first_slice_type(packet->data, (size_t)packet->size);
+    if (slice_type == 5) calibration_start(dev, dev->gop.count);
+    gop_cache_add(&dev->gop, job, slice_type);
+    if (!dev->decoding) {
+        note_access_unit(dev, job);
+        return 0;
+    }
+
+    struct ocam_decoder *in = begin_access_unit(dev, job);
+    if (!in || !decoder_accepts(in, slice_type)) return 0;
+
+    int frames = decode_and_output(dev, in, packet);
+    if (slice_type == 5) record_keyframe_latency(dev, (uint32_t)packet->size, job->recv_start_ns, job->recv_end_ns, 0);
+    return frames;
+}
+
+static int decode_slice_job(struct ocam_device *dev, struct decode_job *job) {
+    AVPacket *packet = job->packet;
+    int type = nal_unit_type(packet->data, (size_t)packet->size);
+    if (type == 5 && (job->first_slice || !dev->gop.au_idr)) calibration_start(dev, job->first_slice ? dev->gop.count : dev->gop.au_start);
+    gop_cache_add(&dev->gop, job, type);
+    if (!dev->decoding) {
+        if (job->first_slice) note_access_unit(dev, job);
+        dev->au_bytes = 0;
+        return 0;
+    }
+
+    if (job->first_slice && !begin_access_unit(dev, job)) return 0;
+
+    struct ocam_decoder *in = input_decoder(dev);
+    if (!in->ctx) return 0;
+
+    int frames = 0;
+    if (type == 5) dev->au_keyframe = true;
+
+    if (decoder_accepts(in, type)) {
+        uint64_t start = os_gettime_ns();
+        frames = decode_and_output(dev, in, packet);
+        if (!job->last_slice) {
+            dev->au_slice_done_ns = os_gettime_ns();
+            dev->au_overlap_ns += dev->au_slice_done_ns - start;
+        }
+    }
+
+    if (job->last_slice && dev->au_keyframe) {
+        // Only decode work finished before the last byte arrived was hidden behind the receive
+        uint64_t overlap = dev->au_overlap_ns;
+        if (dev->au_slice_done_ns > job->recv_end_ns) {
+            uint64_t late = dev->au_slice_done_ns - job->recv_end_ns;
+            overlap = late < overlap ? overlap - late : 0;
+        }
+        record_keyframe_latency(dev, dev->au_bytes + (uint32_t)packet->size, job->recv_start_ns, job->recv_end_ns, overlap);
+    }
+    dev->au_bytes = job->last_slice ? 0 : dev->au_bytes + (uint32_t)packet->size;
+    return frames;
+}
+
+// Stream restart (new resolution/fps): the new configuration comes up on the pending decoder
+static int decode_config_job(struct ocam_device *dev, struct decode_job *job) {
+    AVPacket *packet = job->packet;
+    blog(LOG_INFO, "[OCAM] Config Packet (Stream Restart).");
+
+    // Back-to-back config packets (SPS, PPS) form one extradata; a config after frames replaces it
+    if (!dev->config_open) {
+        free(dev->extradata);
+        dev->extradata = NULL;
+        dev->extradata_size = 0;
+    }
+    uint8_t *new_ptr = realloc(dev->extradata, dev->extradata_size + packet->size);
+    if (new_ptr) {
+        dev->extradata = new_ptr;
+        memcpy(dev->extradata + dev->extradata_size, packet->data, packet->size);
+        dev->extradata_size += packet->size;
+    }
+    dev->config_open = true;
+    dev->first_frame_received = false;
+    gop_cache_clear(&dev->gop);
+    if (!dev->decoding) return 0;
+
+    int frames = 0;
+    bool chunked = job->chunked;
+    const AVCodec *codec = backend_codec(dev, chunked);
+    if (dev->decoder.ctx) {
+        // Show whatever the live decoder still holds; it keeps the last picture until the swap
+        frames += decode_and_output(dev, &dev->decoder, NULL);
+        decoder_close(&dev->pending);
+        if (!decoder_open(dev, &dev->pending, chunked, codec)) {
+            decoder_close(&dev->decoder);
+            if (!decoder_open(dev, &dev->decoder, chunked, codec)) return frames;
+        }
+    } else {
+        decoder_close(&dev->pending);
+        if (!decoder_open(dev, &dev->decoder, chunked, codec)) return frames;
+    }
+
+    return frames + decode_and_output(dev, input_decoder(dev), packet);
+}
+
+static int process_video_job(void *data, struct decode_job *job) {
+    struct ocam_device *dev = data;
+
+    switch (job->type) {
+    case DECODE_JOB_RESET:
+        cleanup_ffmpeg(dev);
+        gop_cache_clear(&dev->gop);
+        dev->first_frame_received = false;
+        return 0;
+
+    case DECODE_JOB_CONFIG:
+        return decode_config_job(dev, job);
+
+    case DECODE_JOB_FRAME:
+        return decode_frame_job(dev, job);
+
+    case DECODE_JOB_SLICE:
+        return decode_slice_job(dev, job);
+
+    case DECODE_JOB_PAUSE:
+        dev->decoding = false;
+        decoder_close(&dev->decoder);
+        decoder_close(&dev->pending);
+        return 0;
+
+    case DECODE_JOB_RESUME:
+        dev->decoding = true;
+        return gop_cache_replay(dev);
+    }
+    return 0;
+}
+
+// --- Video Receive ---
 
-    s->codec_ctx = avcodec_alloc_context3(codec);
-    if (s->extradata_size > 0) {
-        s->codec_ctx->extradata = (uint8_t*)av_malloc(s->extradata_size + AV_INPUT_BUFFER_PADDING_SIZE);
-        memcpy(s->codec_ctx->extradata, s->extradata, s->extradata_size);
-        s->codec_ctx->extradata_size = s->extradata_size;
+#define PACKET_POOL_MIN_SIZE (256 * 1024)
+
+// Payload buffers come from a pool sized to the largest access unit seen so far
+static AVBufferRef *get_packet_buffer(struct ocam_device *dev, uint32_t size) {
+    size_t need = (size_t)size + AV_INPUT_BUFFER_PADDING_SIZE;
+    if (!dev->packet_pool || need > dev->packet_pool_size) {
+        size_t pool_size = PACKET_POOL_MIN_SIZE;
+        while (pool_size < need) pool_size *= 2;
+        // Buffers still queued for decode are freed when they are released
+        av_buffer_pool_uninit(&dev->packet_pool);
+        dev->packet_pool = av_buffer_pool_init(pool_size, NULL);
+        dev->packet_pool_size = dev->packet_pool ? pool_size : 0;
+    }
+
+    AVBufferRef *buf = dev->packet_pool ? av_buffer_pool_get(dev->packet_pool) : NULL;
+    if (buf) memset(buf->data + size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+    return buf;
+}
+
+// Called as a picture starts arriving. A full queue means the decoder has fallen behind;
+// later P-frames are useless without the ones dropped, so skip to the next IDR.
+static void ingest_check_backlog(struct ocam_device *dev) {
+    if (dev->skip_to_idr || !decode_queue_full(&dev->video_queue)) return;
+    dev->skip_to_idr = true;
+    dev->skipped = 0;
+    send_control_command(dev, 0x04, 0, 0);
+}
+
+// Whether a picture (or slice-mode NAL unit) of this NAL type may be queued. An IDR or the
+// SPS in front of it ends the skip.
+static bool ingest_admit(struct ocam_device *dev, int nal_type, bool picture_start) {
+    if (!dev->skip_to_idr) return true;
+    if (nal_type != 5 && nal_type != 7) {
+        if (picture_start) dev->skipped++;
+        return false;
     }
+    dev->skip_to_idr = false;
+    blog(LOG_WARNING, "[OCAM] Decoder fell behind on port %d; dropped %u frames up to the next keyframe", dev->port, dev->skipped);
+    return true;
+}
+
+// Queues a job whose packet references size bytes of buf at offset
+static bool submit_video_job(struct ocam_device *dev, enum decode_job_type type, AVBufferRef *buf, size_t offset, size_t size,
+                             uint64_t pts, uint64_t recv_start, uint64_t recv_end) {
+    struct decode_job *job = decode_queue_get_job(&dev->video_queue, type);
+    if (!job) return false;
+
+    if (buf) {
+        job->packet->buf = av_buffer_ref(buf);
+        if (!job->packet->buf) { decode_queue_recycle_job(&dev->video_queue, job); return false; }
+        job->packet->data = buf->data + offset;
+        job->packet->size = (int)size;
+        job->packet->pts = (int64_t)pts;
+    }
+    job->pts_ns = (int64_t)pts * 1000;
+    job->recv_start_ns = recv_start;
+    job->recv_end_ns = recv_end;
+    job->chunked = dev->chunked_decode;
+    decode_queue_submit(&dev->video_queue, job);
+    return true;
+}
+
+static void submit_slice(struct ocam_device *dev, AVBufferRef *buf, size_t offset, size_t len, uint64_t pts,
+                         bool *first, bool last, uint64_t recv_start, uint64_t recv_end) {
+    struct decode_job *job = decode_queue_get_job(&dev->video_queue, DECODE_JOB_SLICE);
+    if (!job) return;
+
+    job->packet->buf = av_buffer_ref(buf);
+    if (!job->packet->buf) { decode_queue_recycle_job(&dev->video_queue, job); return; }
+    job->packet->data = buf->data + offset;
+    job->packet->size = (int)len;
+    job->packet->pts = (int64_t)pts;
+    job->pts_ns = (int64_t)pts * 1000;
+    job->chunked = true;
+    job->first_slice = *first;
+    job->last_slice = last;
+    job->recv_start_ns = recv_start;
+    job->recv_end_ns = recv_end;
+    decode_queue_submit(&dev->video_queue, job);
+    *first = false;
+}
 
-    s->codec_ctx->flags |= AV_CODEC_FLAG_LOW_DELAY;
-    av_opt_set(s->codec_ctx->priv_data, "tune", "zerolatency", 0);
+// Drops NAL units while skipping to an IDR; the first one kept starts the access unit
+static void admit_slice(struct ocam_device *dev, AVBufferRef *buf, size_t offset, size_t len, uint64_t pts,
+                        bool *first, bool last, uint64_t recv_start, uint64_t recv_end) {
+    if (!ingest_admit(dev, nal_unit_type(buf->data + offset, len), offset == 0)) return;
+    submit_slice(dev, buf, offset, len, pts, first, last, recv_start, recv_end);
+}
+
+static bool admit_picture(struct ocam_device *dev, AVBufferRef *buf, size_t offset, size_t size) {
+    ingest_check_backlog(dev);
+    return ingest_admit(dev, first_slice_type(buf->data + offset, size), true);
+}
 
-    s->decoded_frame = av_frame_alloc();
-    if (avcodec_open2(s->codec_ctx, codec, NULL) < 0) return false;
+// Receives one access unit into buf and queues each NAL unit as soon as the next start code arrives
+static bool receive_slices(struct ocam_device *dev, struct socket_reader *r, AVBufferRef *buf, uint32_t size, uint64_t pts) {
+    uint8_t *data = buf->data;
+    size_t received = 0, sent = 0, scan = 0;
+    bool first = true;
+    uint64_t recv_start = os_gettime_ns();
+    ingest_check_backlog(dev);
+
+    while (received < size) {
+        ssize_t n = reader_read_some(r, data + received, size - received, dev);
+        if (n <= 0) return false;
+        received += (size_t)n;
+
+        size_t next;
+        while ((next = find_start_code(data, scan, received)) != NAL_NOT_FOUND) {
+            if (next > sent) admit_slice(dev, buf, sent, next - sent, pts, &first, false, recv_start, 0);
+            sent = next;
+            scan = next + 3;
+        }
+        // A start code may straddle the next read
+        if (received > scan + 2) scan = received - 2;
+    }
 
-    s->codec_initialized = true;
+    // The last NAL unit completes the picture
+    if (size > sent) admit_slice(dev, buf, sent, size - sent, pts, &first, true, recv_start, os_gettime_ns());
     return true;
 }
 
 static void *network_thread_func(void *data) {
-    struct ocam_source *s = data;
-    AVPacket *packet = NULL;
+    struct ocam_device *dev = data;
+    struct socket_reader *reader = bzalloc(sizeof(struct socket_reader));
 
-    s->video_server_fd = create_bind_socket(VIDEO_PORT);
-    if (s->video_server_fd < 0) return NULL;
-    if (listen(s->video_server_fd, 1) < 0) { CLOSESOCKET(s->video_server_fd); return NULL; }
+    dev->video_server_fd = create_bind_socket(dev, dev->port);
+    if (dev->video_server_fd < 0) { bfree(reader); return NULL; }
+    if (listen(dev->video_server_fd, 1) < 0) { CLOSESOCKET(dev->video_server_fd); bfree(reader); return NULL; }
 
-    while (s->thread_running) {
-        int client = accept_with_timeout(s->video_server_fd, s);
+    char thread_name[16];
+    snprintf(thread_name, sizeof(thread_name), "ocam-net-%d", dev->port);
+    struct thread_slot *slot = thread_policy_enter(STAGE_INGEST, thread_name);
+
+    while (dev->thread_running) {
+        thread_policy_tick(slot);
+        int client = accept_with_timeout(dev->video_server_fd, dev);
 
         if (client < 0) continue;
-        if (!s->thread_running) { CLOSESOCKET(client); break; }
+        if (!dev->thread_running) { CLOSESOCKET(client); break; }
         
         int opt = 1;
         setsockopt(client, IPPROTO_TCP, TCP_NODELAY, (SOCKOPT_VAL_TYPE)&opt, sizeof(opt));
 
-        pthread_mutex_lock(&s->mutex);
-        s->video_client_fd = client;
-        pthread_mutex_unlock(&s->mutex);
+        pthread_mutex_lock(&dev->mutex);
+        dev->video_client_fd = client;
+        pthread_mutex_unlock(&dev->mutex);
+
+        reader_reset(reader, client);
 
         char name[NAME_BUFFER_SIZE];
         uint32_t config[3];
-        if (read_bytes_fully(client, name, NAME_BUFFER_SIZE, s) <= 0 || read_bytes_fully(client, config, sizeof(config), s) <= 0) {
+        if (reader_read_fully(reader, name, NAME_BUFFER_SIZE, dev) <= 0 || reader_read_fully(reader, config, sizeof(config), dev) <= 0) {
             CLOSESOCKET(client); continue;
         }
 
         blog(LOG_INFO, "[OCAM] Video Connection Established. Waiting for stream...");
+        submit_video_job(dev, DECODE_JOB_RESET, NULL, 0, 0, 0, 0, 0);
+        memset(&dev->ingest_window, 0, sizeof(dev->ingest_window));
+        dev->skip_to_idr = false;
 
-        cleanup_ffmpeg(s);
-        s->first_frame_received = false;
-        packet = av_packet_alloc();
+        while (dev->thread_running) {
+            thread_policy_tick(slot);
+            uint8_t header[12];
+            if (reader_read_fully(reader, header, sizeof(header), dev) <= 0) break;
 
-        while (s->thread_running) {
             uint64_t pts_net;
             uint32_t size_net;
-
-            if (read_bytes_fully(client, &pts_net, sizeof(pts_net), s) <= 0) break;
-            if (read_bytes_fully(client, &size_net, sizeof(size_net), s) <= 0) break;
-
+            memcpy(&pts_net, header, sizeof(pts_net));
+            memcpy(&size_net, header + 8, sizeof(size_net));
             uint64_t pts = portable_ntohll(pts_net);
             uint32_t size = portable_ntohl(size_net);
 
-            if (av_new_packet(packet, size) < 0) break;
-            if (read_bytes_fully(client, packet->data, size, s) != size) { av_packet_unref(packet); break; }
-
-            // PTS 0 = Config Packet (Stream Restart)
-            if (pts == 0) {
-                blog(LOG_INFO, "[OCAM] Config Packet (Stream Restart).");
-                uint8_t *new_ptr = realloc(s->extradata, s->extradata_size + size);
-                if (new_ptr) {
-                    s->extradata = new_ptr;
-                    memcpy(s->extradata + s->extradata_size, packet->data, size);
-                    s->extradata_size += size;
-                }
-                if (s->codec_initialized) avcodec_flush_buffers(s->codec_ctx);
-                s->first_frame_received = false;
-            }
-
-            if (!s->codec_initialized) {
-                if (!init_ffmpeg(s)) { av_packet_unref(packet); break; }
+            uint64_t recv_start = os_gettime_ns();
+            struct cadence_stats ingest;
+            if (pts > 0 && cadence_tick(&dev->ingest_window, recv_start, &ingest)) {
+                pthread_mutex_lock(&dev->mutex);
+                dev->ingest_stats = ingest;
+                pthread_mutex_unlock(&dev->mutex);
             }
 
-            int64_t pts_ns = (int64_t)pts * 1000;
-
-            if (!s->first_frame_received && pts > 0) {
-                s->timestamp_offset = (int64_t)os_gettime_ns() - pts_ns;
-                s->first_frame_received = true;
-            }
-
-            packet->pts = pts;
-            if (avcodec_send_packet(s->codec_ctx, packet) >= 0) {
-                while (avcodec_receive_frame(s->codec_ctx, s->decoded_frame) >= 0) {
-                    if ((uint32_t)s->decoded_frame->width != s->width || (uint32_t)s->decoded_frame->height != s->height) {
-                        s->width = (uint32_t)s->decoded_frame->width;
-                        s->height = (uint32_t)s->decoded_frame->height;
-                    }
+            AVBufferRef *buf = get_packet_buffer(dev, size);
+            if (!buf) break;
 
-                    enum video_format obs_fmt = convert_pixel_format(s->decoded_frame->format);
-                    if (obs_fmt == VIDEO_FORMAT_NONE) continue;
-
-                    struct obs_source_frame obs_frame = {0};
-                    for (int i = 0; i < MAX_AV_PLANES; i++) {
-                        obs_frame.data[i] = s->decoded_frame->data[i];
-                        obs_frame.linesize[i] = abs(s->decoded_frame->linesize[i]);
-                    }
-                    obs_frame.format = obs_fmt;
-                    obs_frame.width = s->decoded_frame->width;
-                    obs_frame.height = s->decoded_frame->height;
-                    obs_frame.full_range = (s->decoded_frame->color_range == AVCOL_RANGE_JPEG);
-                    obs_frame.timestamp = pts_ns + s->timestamp_offset;
-
-                    enum video_colorspace cs = convert_color_space(s->decoded_frame->colorspace);
-                    video_format_get_parameters_for_format(cs, s->decoded_frame->color_range == AVCOL_RANGE_JPEG ? VIDEO_RANGE_FULL : VIDEO_RANGE_PARTIAL,
-                                                           obs_fmt, obs_frame.color_matrix, obs_frame.color_range_min, obs_frame.color_range_max);
-
-                    obs_source_output_video(s->source, &obs_frame);
+            bool ok;
+            if (pts > 0 && dev->chunked_decode) {
+                ok = receive_slices(dev, reader, buf, size, pts);
+            } else {
+                ok = reader_read_fully(reader, buf->data, size, dev) == (ssize_t)size;
+                if (ok && pts == 0) {
+                    // PTS 0 = Config Packet (Stream Restart). The first picture after an encoder
+                    // start has pts 0 too, so only the SPS/PPS part counts as config.
+                    uint64_t recv_end = os_gettime_ns();
+                    size_t config = config_prefix_size(buf->data, size);
+                    if (config > 0) submit_video_job(dev, DECODE_JOB_CONFIG, buf, 0, config, pts, recv_start, recv_end);
+                    if (config < size && admit_picture(dev, buf, config, size - config))
+                        submit_video_job(dev, DECODE_JOB_FRAME, buf, config, size - config, pts, recv_start, recv_end);
+                } else if (ok && admit_picture(dev, buf, 0, size)) {
+                    submit_video_job(dev, DECODE_JOB_FRAME, buf, 0, size, pts, recv_start, os_gettime_ns());
                 }
             }
-            av_packet_unref(packet);
+            av_buffer_unref(&buf);
+            if (!ok) break;
         }
 
-        pthread_mutex_lock(&s->mutex);
-        if(s->video_client_fd != -1) { CLOSESOCKET(s->video_client_fd); s->video_client_fd = -1; }
-        pthread_mutex_unlock(&s->mutex);
-        if (packet) { av_packet_free(&packet); packet = NULL; }
-        cleanup_ffmpeg(s);
+        pthread_mutex_lock(&dev->mutex);
+        if(dev->video_client_fd != -1) { CLOSESOCKET(dev->video_client_fd); dev->video_client_fd = -1; }
+        pthread_mutex_unlock(&dev->mutex);
+        submit_video_job(dev, DECODE_JOB_RESET, NULL, 0, 0, 0, 0, 0);
     }
-    if (packet) av_packet_free(&packet);
-    CLOSESOCKET(s->video_server_fd);
+    av_buffer_pool_uninit(&dev->packet_pool);
+    bfree(reader);
+    CLOSESOCKET(dev->video_server_fd);
+    thread_policy_exit(slot);
     return NULL;
 }
 
 // --- Audio FFmpeg Utils ---
 
-static void cleanup_audio_ffmpeg(struct ocam_source *s) {
-    if (s->audio_codec_ctx) { avcodec_free_context(&s->audio_codec_ctx); s->audio_codec_ctx = NULL; }
-    if (s->audio_decoded_frame) { av_frame_free(&s->audio_decoded_frame); s->audio_decoded_frame = NULL; }
-    if (s->audio_extradata) { free(s->audio_extradata); s->audio_extradata = NULL; }
-    s->audio_extradata_size = 0;
-    s->audio_codec_initialized = false;
+static void cleanup_audio_ffmpeg(struct ocam_device *dev) {
+    if (dev->audio_codec_ctx) { avcodec_free_context(&dev->audio_codec_ctx); dev->audio_codec_ctx = NULL; }
+    if (dev->audio_decoded_frame) { av_frame_free(&dev->audio_decoded_frame); dev->audio_decoded_frame = NULL; }
+    if (dev->audio_extradata) { free(dev->audio_extradata); dev->audio_extradata = NULL; }
+    dev->audio_extradata_size = 0;
+    dev->audio_codec_initialized = false;
 }
 
-static bool init_audio_ffmpeg(struct ocam_source *s) {
+static bool init_audio_ffmpeg(struct ocam_device *dev) {
     const AVCodec *codec = avcodec_find_decoder(AV_CODEC_ID_AAC);
     if (!codec) return false;
 
-    s->audio_codec_ctx = avcodec_alloc_context3(codec);
+    dev->audio_codec_ctx = avcodec_alloc_context3(codec);
     
-    if (s->audio_extradata_size > 0) {
-        s->audio_codec_ctx->extradata = (uint8_t*)av_malloc(s->audio_extradata_size + AV_INPUT_BUFFER_PADDING_SIZE);
-        memcpy(s->audio_codec_ctx->extradata, s->audio_extradata, s->audio_extradata_size);
-        s->audio_codec_ctx->extradata_size = s->audio_extradata_size;
+    if (dev->audio_extradata_size > 0) {
+        dev->audio_codec_ctx->extradata = (uint8_t*)av_malloc(dev->audio_extradata_size + AV_INPUT_BUFFER_PADDING_SIZE);
+        memcpy(dev->audio_codec_ctx->extradata, dev->audio_extradata, dev->audio_extradata_size);
+        dev->audio_codec_ctx->extradata_size = dev->audio_extradata_size;
     }
 
-    s->audio_decoded_frame = av_frame_alloc();
-    if (avcodec_open2(s->audio_codec_ctx, codec, NULL) < 0) return false;
+    dev->audio_decoded_frame = av_frame_alloc();
+    if (avcodec_open2(dev->audio_codec_ctx, codec, NULL) < 0) return false;
 
-    s->audio_codec_initialized = true;
+    dev->audio_codec_initialized = true;
     return true;
 }
 
 static void *audio_thread_func(void *data) {
-    struct ocam_source *s = data;
+    struct ocam_device *dev = data;
     AVPacket *packet = NULL;
 
-    s->audio_server_fd = create_bind_socket(AUDIO_PORT);
-    if (s->audio_server_fd < 0) return NULL;
-    if (listen(s->audio_server_fd, 1) < 0) { CLOSESOCKET(s->audio_server_fd); return NULL; }
+    dev->audio_server_fd = create_bind_socket(dev, dev->port + AUDIO_PORT - VIDEO_PORT);
+    if (dev->audio_server_fd < 0) return NULL;
+    if (listen(dev->audio_server_fd, 1) < 0) { CLOSESOCKET(dev->audio_server_fd); return NULL; }
+
+    char thread_name[16];
+    snprintf(thread_name, sizeof(thread_name), "ocam-aud-%d", dev->port);
+    struct thread_slot *slot = thread_policy_enter(STAGE_AUDIO, thread_name);
 
-    while (s->thread_running) {
-        int client = accept_with_timeout(s->audio_server_fd, s);
+    while (dev->thread_running) {
+        thread_policy_tick(slot);
+        int client = accept_with_timeout(dev->audio_server_fd, dev);
 
         if (client < 0) continue;
-        if (!s->thread_running) { CLOSESOCKET(client); break; }
+        if (!dev->thread_running) { CLOSESOCKET(client); break; }
         
         // TCP_NODELAY
         int opt = 1;
         setsockopt(client, IPPROTO_TCP, TCP_NODELAY, (SOCKOPT_VAL_TYPE)&opt, sizeof(opt));
 
-        pthread_mutex_lock(&s->mutex);
-        s->audio_client_fd = client;
-        pthread_mutex_unlock(&s->mutex);
+        pthread_mutex_lock(&dev->mutex);
+        dev->audio_client_fd = client;
+        pthread_mutex_unlock(&dev->mutex);
 
         // Handshake: Read 4 bytes magic "AAC "
         uint32_t magic;
-        if (read_bytes_fully(client, &magic, sizeof(magic), s) <= 0) {
+        if (read_bytes_fully(client, &magic, sizeof(magic), dev) <= 0) {
             CLOSESOCKET(client); continue;
         }
 
         blog(LOG_INFO, "[OCAM] Audio Connection Established.");
 
-        cleanup_audio_ffmpeg(s);
-        s->first_audio_received = false;
+        cleanup_audio_ffmpeg(dev);
+        dev->first_audio_received = false;
         packet = av_packet_alloc();
 
-        while (s->thread_running) {
+        while (dev->thread_running) {
+            thread_policy_tick(slot);
             uint64_t pts_net;
             uint32_t size_net;
 
-            if (read_bytes_fully(client, &pts_net, sizeof(pts_net), s) <= 0) break;
-            if (read_bytes_fully(client, &size_net, sizeof(size_net), s) <= 0) break;
+            if (read_bytes_fully(client, &pts_net, sizeof(pts_net), dev) <= 0) break;
+            if (read_bytes_fully(client, &size_net, sizeof(size_net), dev) <= 0) break;
 
             uint64_t pts = portable_ntohll(pts_net);
             uint32_t size = portable_ntohl(size_net);
 
             if (av_new_packet(packet, size) < 0) break;
-            if (read_bytes_fully(client, packet->data, size, s) != size) { av_packet_unref(packet); break; }
+            if (read_bytes_fully(client, packet->data, size, dev) != size) { av_packet_unref(packet); break; }
 
             // Init codec if needed (using first packet as config/data)
-            if (!s->audio_codec_initialized) {
-                 if (s->audio_extradata_size == 0) {
-                     s->audio_extradata = malloc(size);
-                     memcpy(s->audio_extradata, packet->data, size);
-                     s->audio_extradata_size = size;
+            if (!dev->audio_codec_initialized) {
+                 if (dev->audio_extradata_size == 0) {
+                     dev->audio_extradata = malloc(size);
+                     memcpy(dev->audio_extradata, packet->data, size);
+                     dev->audio_extradata_size = size;
                  }
-                 if (!init_audio_ffmpeg(s)) { av_packet_unref(packet); continue; }
+                 if (!init_audio_ffmpeg(dev)) { av_packet_unref(packet); continue; }
             }
 
             int64_t pts_ns = (int64_t)pts * 1000;
-            if (!s->first_audio_received) {
+            if (!dev->first_audio_received) {
                 // Sync audio with video offset logic
-                s->audio_timestamp_offset = (int64_t)os_gettime_ns() - pts_ns;
-                s->first_audio_received = true;
+                dev->audio_timestamp_offset = (int64_t)os_gettime_ns() - pts_ns;
+                dev->first_audio_received = true;
             }
 
             packet->pts = pts;
             
-            if (avcodec_send_packet(s->audio_codec_ctx, packet) >= 0) {
-                while (avcodec_receive_frame(s->audio_codec_ctx, s->audio_decoded_frame) >= 0) {
+            if (avcodec_send_packet(dev->audio_codec_ctx, packet) >= 0) {
+                while (avcodec_receive_frame(dev->audio_codec_ctx, dev->audio_decoded_frame) >= 0) {
                     
                     struct obs_source_audio obs_audio = {0};
                     
                     // OBS expects planar float for FLOAT_PLANAR, interleaved for others
                     // FFmpeg's AAC decoder usually outputs FLTP (Float Planar)
                     for(int i=0; i<MAX_AV_PLANES; i++) {
-                         obs_audio.data[i] = s->audio_decoded_frame->data[i];
+                         obs_audio.data[i] = dev->audio_decoded_frame->data[i];
                     }
                     
-                    obs_audio.frames = s->audio_decoded_frame->nb_samples;
+                    obs_audio.frames = dev->audio_decoded_frame->nb_samples;
                     
                     // Map Format
-                    if (s->audio_codec_ctx->sample_fmt == AV_SAMPLE_FMT_FLTP) obs_audio.format = AUDIO_FORMAT_FLOAT_PLANAR;
-                    else if (s->audio_codec_ctx->sample_fmt == AV_SAMPLE_FMT_FLT) obs_audio.format = AUDIO_FORMAT_FLOAT;
-                    else if (s->audio_codec_ctx->sample_fmt == AV_SAMPLE_FMT_S16P) obs_audio.format = AUDIO_FORMAT_16BIT_PLANAR;
+                    if (dev->audio_codec_ctx->sample_fmt == AV_SAMPLE_FMT_FLTP) obs_audio.format = AUDIO_FORMAT_FLOAT_PLANAR;
+                    else if (dev->audio_codec_ctx->sample_fmt == AV_SAMPLE_FMT_FLT) obs_audio.format = AUDIO_FORMAT_FLOAT;
+                    else if (dev->audio_codec_ctx->sample_fmt == AV_SAMPLE_FMT_S16P) obs_audio.format = AUDIO_FORMAT_16BIT_PLANAR;
                     else obs_audio.format = AUDIO_FORMAT_16BIT;
 
                     // Channel Layout (Modern FFmpeg uses ch_layout, older uses channels)
                     #if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(59, 37, 100)
-                        int channels = s->audio_codec_ctx->ch_layout.nb_channels;
+                        int channels = dev->audio_codec_ctx->ch_layout.nb_channels;
                     #else
-                        int channels = s->audio_codec_ctx->channels;
+                        int channels = dev->audio_codec_ctx->channels;
                     #endif
 
                     obs_audio.speakers = (channels == 2) ? SPEAKERS_STEREO : SPEAKERS_MONO;
-                    obs_audio.samples_per_sec = s->audio_codec_ctx->sample_rate;
-                    obs_audio.timestamp = pts_ns + s->audio_timestamp_offset;
+                    obs_audio.samples_per_sec = dev->audio_codec_ctx->sample_rate;
+                    obs_audio.timestamp = pts_ns + dev->audio_timestamp_offset + os_atomic_load_long(&dev->audio_delay_ns);
 
-                    obs_source_output_audio(s->source, &obs_audio);
+                    pthread_mutex_lock(&dev->sub_mutex);
+                    for (struct ocam_source *sub = dev->subscribers; sub; sub = sub->next)
+                        obs_source_output_audio(sub->source, &obs_audio);
+                    pthread_mutex_unlock(&dev->sub_mutex);
                 }
             }
             av_packet_unref(packet);
         }
 
-        pthread_mutex_lock(&s->mutex);
-        if(s->audio_client_fd != -1) { CLOSESOCKET(s->audio_client_fd); s->audio_client_fd = -1; }
-        pthread_mutex_unlock(&s->mutex);
+        pthread_mutex_lock(&dev->mutex);
+        if(dev->audio_client_fd != -1) { CLOSESOCKET(dev->audio_client_fd); dev->audio_client_fd = -1; }
+        pthread_mutex_unlock(&dev->mutex);
         if (packet) { av_packet_free(&packet); packet = NULL; }
-        cleanup_audio_ffmpeg(s);
+        cleanup_audio_ffmpeg(dev);
     }
     if (packet) av_packet_free(&packet);
-    CLOSESOCKET(s->audio_server_fd);
+    CLOSESOCKET(dev->audio_server_fd);
+    thread_policy_exit(slot);
     return NULL;
 }
 
 
-// --- Main Lifecycle ---
+// --- Properties & Settings ---
 
-static void ocam_destroy(void *data) {
-    struct ocam_source *s = data;
-    s->thread_running = false;
+static bool ocam_recalibrate(obs_properties_t *props, obs_property_t *property, void *data) {
+    UNUSED_PARAMETER(props);
+    UNUSED_PARAMETER(property);
+    struct ocam_source *sub = data;
+    backend_forget((int)sub->device->width, (int)sub->device->height);
+    return true;
+}
 
-    pthread_mutex_lock(&s->mutex);
-    if (s->video_client_fd != -1) { shutdown(s->video_client_fd, SHUTDOWN_FLAGS); CLOSESOCKET(s->video_client_fd); s->video_client_fd = -1; }
-    if (s->control_client_fd != -1) { shutdown(s->control_client_fd, SHUTDOWN_FLAGS); CLOSESOCKET(s->control_client_fd); s->control_client_fd = -1; }
-    if (s->audio_client_fd != -1) { shutdown(s->audio_client_fd, SHUTDOWN_FLAGS); CLOSESOCKET(s->audio_client_fd); s->audio_client_fd = -1; }
-    
-    if (s->video_server_fd != -1) { shutdown(s->video_server_fd, SHUTDOWN_FLAGS); CLOSESOCKET(s->video_server_fd); s->video_server_fd = -1; }
-    if (s->control_server_fd != -1) { shutdown(s->control_server_fd, SHUTDOWN_FLAGS); CLOSESOCKET(s->control_server_fd); s->control_server_fd = -1; }
-    if (s->audio_server_fd != -1) { shutdown(s->audio_server_fd, SHUTDOWN_FLAGS); CLOSESOCKET(s->audio_server_fd); s->audio_server_fd = -1; }
-    pthread_mutex_unlock(&s->mutex);
+// Called with dev->mutex held. Once the phone has listed its high-speed sizes, rates
+// above the regular maximum are only offered at the sizes that support them.
+static bool fps_offered(struct ocam_device *dev, int w, int h, int fps) {
+    if (dev->regular_fps_max <= 0 || fps <= dev->regular_fps_max) return true;
+    for (int i = 0; i < dev->supported_res_count; i++) {
+        const struct ocam_res *res = &dev->supported_resolutions[i];
+        if (res->w != w || res->h != h) continue;
+        for (int r = 0; r < res->high_speed_count; r++)
+            if (res->high_speed_fps[r] == fps) return true;
+    }
+    return false;
+}
 
-    if (s->network_thread_active) pthread_join(s->network_thread, NULL);
-    if (s->control_thread_active) pthread_join(s->control_thread, NULL);
-    if (s->audio_thread_active) pthread_join(s->audio_thread, NULL);
+// Called with dev->mutex held
+static void fill_fps_list(struct ocam_device *dev, obs_property_t *fps_list, int w, int h) {
+    if (!dev->caps_received || dev->supported_fps_count == 0) {
+        obs_property_list_add_int(fps_list, "60 FPS", 60);
+        obs_property_list_add_int(fps_list, "30 FPS", 30);
+        obs_property_list_add_int(fps_list, "24 FPS", 24);
+        obs_property_list_add_int(fps_list, "15 FPS", 15);
+        return;
+    }
+    for (int i = 0; i < dev->supported_fps_count; i++) {
+        int fps = dev->supported_fps[i];
+        if (!fps_offered(dev, w, h, fps)) continue;
+        bool high_speed = dev->regular_fps_max > 0 ? fps > dev->regular_fps_max : fps > 60;
+        struct dstr label = {0};
+        dstr_printf(&label, high_speed ? "%d FPS (High Speed)" : "%d FPS", fps);
+        obs_property_list_add_int(fps_list, label.array, fps);
+        dstr_free(&label);
+    }
+}
+
+// Keeps the FPS list to the rates the phone can stream at the chosen resolution
+static bool ocam_resolution_modified(void *data, obs_properties_t *props, obs_property_t *property, obs_data_t *settings) {
+    UNUSED_PARAMETER(property);
+    struct ocam_source *sub = data;
+    struct ocam_device *dev = sub->device;
+    obs_property_t *fps_list = obs_properties_get(props, "fps");
+    if (!fps_list) return false;
+
+    int w = 0, h = 0;
+    sscanf(obs_data_get_string(settings, "resolution"), "%dx%d", &w, &h);
+    int fps = (int)obs_data_get_int(settings, "fps");
 
-    if (s->supported_resolutions) free(s->supported_resolutions);
-    pthread_mutex_destroy(&s->mutex);
-    cleanup_ffmpeg(s);
-    cleanup_audio_ffmpeg(s);
-    bfree(s);
+    obs_property_list_clear(fps_list);
+    pthread_mutex_lock(&dev->mutex);
+    fill_fps_list(dev, fps_list, w, h);
+    // A high-speed rate this size cannot stream falls back to the nearest lower one
+    if (dev->caps_received && !fps_offered(dev, w, h, fps)) {
+        int best = 0;
+        for (int i = 0; i < dev->supported_fps_count; i++) {
+            int rate = dev->supported_fps[i];
+            if (rate < fps && rate > best && fps_offered(dev, w, h, rate)) best = rate;
+        }
+        if (best > 0) obs_data_set_int(settings, "fps", best);
+    }
+    pthread_mutex_unlock(&dev->mutex);
+    return true;
 }
 
-static void *ocam_create(obs_data_t *settings, obs_source_t *source) {
-    UNUSED_PARAMETER(settings);
-    struct ocam_source *s = bzalloc(sizeof(struct ocam_source));
-    s->source = source;
-    s->thread_running = true;
-    s->video_server_fd = -1; s->video_client_fd = -1;
-    s->control_server_fd = -1; s->control_client_fd = -1;
-    s->audio_server_fd = -1; s->audio_client_fd = -1;
+static obs_properties_t *ocam_get_properties(void *data) {
+    struct ocam_source *sub = data;
+    struct ocam_device *dev = sub->device;
+    obs_properties_t *props = obs_properties_create();
+
+    obs_property_t *port = obs_properties_add_int(props, "port", "Port", 1024, 65533, 1);
+    obs_property_set_long_description(port, "Video port the phone connects to; control and audio use the next two. "
+                                            "Sources with the same port share one phone stream and one decoder.");
+    struct dstr port_error = {0};
+    long bind_failed = os_atomic_load_long(&dev->bind_failed_port);
+    if (sub->port_conflict && sub->port != sub->requested_port)
+        dstr_printf(&port_error, "Port %d overlaps the OCam source on port %d (each phone uses three consecutive ports). Still using port %d.",
+                    sub->requested_port, sub->port_conflict, sub->port);
+    else if (sub->port_conflict)
+        dstr_printf(&port_error, "Port %d overlaps the OCam source on port %d (each phone uses three consecutive ports).",
+                    sub->port, sub->port_conflict);
+    else if (bind_failed)
+        dstr_printf(&port_error, "Could not open port %ld; it is used by another program or OCam source.", bind_failed);
+    if (port_error.len) {
+        obs_property_t *error = obs_properties_add_text(props, "port_error", port_error.array, OBS_TEXT_INFO);
+        obs_property_text_set_info_type(error, OBS_TEXT_INFO_ERROR);
+    }
+    dstr_free(&port_error);
+
+    obs_property_t *list = obs_properties_add_list(props, "resolution", "Resolution", OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+    pthread_mutex_lock(&dev->mutex);
+    if (dev->caps_received && dev->supported_res_count > 0) {
+        for (int i = 0; i < dev->supported_res_count; i++) {
+            struct dstr label = {0};
+            dstr_printf(&label, "%dx%d", dev->supported_resolutions[i].w, dev->supported_resolutions[i].h);
+            obs_property_list_add_string(list, label.array, label.array);
+            dstr_free(&label);
+        }
+    } else {
+        obs_property_list_add_string(list, "1280x720", "1280x720");
+        obs_property_list_add_string(list, "1920x1080", "1920x1080");
+        if (!dev->caps_received) obs_property_set_description(list, "Resolution (Connect phone to populate)");
+    }
+
+    // Refilled for the selected resolution by ocam_resolution_modified
+    obs_property_t *fps_list = obs_properties_add_list(props, "fps", "FPS", OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+    fill_fps_list(dev, fps_list, dev->current_w, dev->current_h);
+    obs_property_set_modified_callback2(list, ocam_resolution_modified, sub);
+
+    obs_property_t *bit_list = obs_properties_add_list(props, "bitrate", "Bitrate", OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+    obs_property_list_add_int(bit_list, "1 Mbps", 1);
+    obs_property_list_add_int(bit_list, "2 Mbps", 2);
+    obs_property_list_add_int(bit_list, "4 Mbps", 4);
+    obs_property_list_add_int(bit_list, "6 Mbps", 6);
+    obs_property_list_add_int(bit_list, "8 Mbps", 8);
+    obs_property_list_add_int(bit_list, "12 Mbps", 12);
+    obs_property_list_add_int(bit_list, "20 Mbps", 20);
+    obs_property_list_add_int(bit_list, "50 Mbps (High)", 50);
+
+    obs_properties_add_bool(props, "flash", "Flash / Torch");
+
+    obs_property_t *chunked = obs_properties_add_bool(props, "chunked_decode", "Low-Latency Slice Decoding");
+    obs_property_set_long_description(chunked, "Decode each slice as soon as it arrives instead of waiting for the whole frame. Reduces latency on large keyframes.");
+
+    obs_property_t *jitter = obs_properties_add_int_slider(props, "jitter_window", "Jitter Window ms (-1=Auto, 0=Off)", -1, PACER_MAX_WINDOW_MS, 1);
+    obs_property_set_long_description(jitter, "Hold decoded frames this long and release them on the phone's own frame cadence, "
+                                              "so bursty USB/Wi-Fi delivery does not cause doubled or skipped frames. "
+                                              "Off shows every frame as soon as it is decoded (OBS unbuffered mode). "
+                                              "Auto sizes the window from measured jitter and lets OBS buffer when the gaps are larger.");
+
+    obs_property_t *prio_list = obs_properties_add_list(props, "decode_priority", "Decode Priority", OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
+    obs_property_list_add_int(prio_list, "Auto (High while in Program)", 0);
+    obs_property_list_add_int(prio_list, "High", 1);
+    obs_property_list_add_int(prio_list, "Normal", 2);
+
+    obs_property_t *backend_list = obs_properties_add_list(props, "decoder_backend", "Decoder", OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_STRING);
+    obs_property_list_add_string(backend_list, "Auto (fastest measured)", "");
+    void *it = NULL;
+    const AVCodec *codec;
+    while ((codec = av_codec_iterate(&it))) {
+        if (!backend_eligible(codec)) continue;
+        obs_property_list_add_string(backend_list, codec->long_name ? codec->long_name : codec->name, codec->name);
+    }
+    obs_property_set_long_description(backend_list, "Frame decoding only; slice decoding always uses the built-in decoder.");
+    obs_properties_add_button(props, "recalibrate", "Re-run Decoder Calibration", ocam_recalibrate);
+
+    struct decode_queue_stats st;
+    int workers = 0, sources = 0;
+    double total_fps = decode_pool_total_fps(&workers, &sources);
+    struct dstr info = {0};
+    if (!dev->decode_wanted)
+        dstr_copy(&info, "Decode: Paused (no source visible, caching GOP)");
+    else if (decode_queue_get_stats(&dev->video_queue, &st))
+        dstr_printf(&info, "Decode: %.1f fps, queue delay avg %.2f ms / max %.2f ms", st.fps, st.delay_avg_ms, st.delay_max_ms);
+    else
+        dstr_copy(&info, "Decode: Idle");
+    dstr_catf(&info, " | Pool: %d workers, %d devices, %.1f fps total", workers, sources, total_fps);
+    pthread_mutex_lock(&dev->sub_mutex);
+    if (dev->subscriber_count > 1) dstr_catf(&info, " | Shared by %d sources", dev->subscriber_count);
+    bool unbuffered = dev->async_unbuffered;
+    pthread_mutex_unlock(&dev->sub_mutex);
+    obs_properties_add_text(props, "decode_stats", info.array, OBS_TEXT_INFO);
+
+    backend_describe(dev, &info);
+    obs_properties_add_text(props, "decoder_info", info.array, OBS_TEXT_INFO);
+
+    if (cadence_current(&dev->output_stats)) {
+        dstr_printf(&info, "Ingest: %.1f fps (jitter %.2f ms) | Decoded: %.1f fps (jitter %.2f ms, max gap %.2f ms)",
+                    dev->ingest_stats.fps, dev->ingest_stats.jitter_ms, dev->output_stats.fps, dev->output_stats.jitter_ms,
+                    dev->output_stats.max_interval_ms);
+        if (cadence_current(&dev->present_stats))
+            dstr_catf(&info, " | Presented: %.1f fps (jitter %.2f ms, max gap %.2f ms)", dev->present_stats.fps,
+                      dev->present_stats.jitter_ms, dev->present_stats.max_interval_ms);
+        dstr_catf(&info, " | Window %.1f ms, OBS %s", dev->pacer.window_ns / 1e6, unbuffered ? "unbuffered" : "buffered");
+        obs_properties_add_text(props, "cadence_stats", info.array, OBS_TEXT_INFO);
+    }
+    thread_policy_describe(&info);
+    obs_properties_add_text(props, "thread_stats", info.array, OBS_TEXT_INFO);
+    dstr_free(&info);
+
+    obs_properties_t *manual_grp = obs_properties_create();
+    int iso_max = (dev->caps_received && dev->iso_max > 0) ? dev->iso_max : 3200;
+    obs_properties_add_int_slider(manual_grp, "iso", "ISO (0=Auto)", 0, iso_max, 1);
+    int exp_max = (dev->caps_received && dev->exp_max > 0) ? dev->exp_max : 100000;
+    obs_properties_add_int_slider(manual_grp, "exposure", "Exposure µs (0=Auto)", 0, exp_max, 100);
+    obs_properties_add_int_slider(manual_grp, "focus", "Focus (-1=Auto, 0-1000 Manual)", -1, 1000, 1);
+
+    pthread_mutex_unlock(&dev->mutex);
+    obs_properties_add_group(props, "manual_controls", "Manual Controls", OBS_GROUP_NORMAL, manual_grp);
+
+    obs_properties_t *thread_grp = obs_properties_create();
+    obs_property_t *elevate = obs_properties_add_bool(thread_grp, "thread_priority", "Raise Ingest/Decode/Audio Priority");
+    obs_property_set_long_description(elevate, "Audio runs highest, then network ingest, decoding and frame pacing; calibration runs below normal. "
+                                               "On Linux raising needs CAP_SYS_NICE or an RLIMIT_NICE allowance, otherwise the threads stay at normal priority. "
+                                               "Applies to every OCam source.");
+    obs_property_t *cores = obs_properties_add_text(thread_grp, "ingest_cores", "Ingest Cores", OBS_TEXT_DEFAULT);
+    obs_property_set_long_description(cores, "CPU cores for the network threads, e.g. \"2,3\" or \"4-7\". Empty = any core.");
+    cores = obs_properties_add_text(thread_grp, "decode_cores", "Decode Cores", OBS_TEXT_DEFAULT);
+    obs_property_set_long_description(cores, "CPU cores for the shared decode workers. Empty = any core.");
+    cores = obs_properties_add_text(thread_grp, "audio_cores", "Audio Cores", OBS_TEXT_DEFAULT);
+    obs_property_set_long_description(cores, "CPU cores for the audio threads. Empty = any core.");
+    obs_properties_add_group(props, "thread_scheduling", "Thread Scheduling", OBS_GROUP_NORMAL, thread_grp);
+    return props;
+}
+
+static void ocam_get_defaults(obs_data_t *settings) {
+    obs_data_set_default_int(settings, "port", VIDEO_PORT);
+    obs_data_set_default_string(settings, "resolution", "1280x720");
+    obs_data_set_default_int(settings, "fps", 30);
+    obs_data_set_default_int(settings, "bitrate", 2);
+    obs_data_set_default_bool(settings, "flash", false);
+    obs_data_set_default_bool(settings, "chunked_decode", false);
+    obs_data_set_default_int(settings, "decode_priority", 0);
+    obs_data_set_default_string(settings, "decoder_backend", "");
+    obs_data_set_default_int(settings, "jitter_window", -1);
+    obs_data_set_default_bool(settings, "thread_priority", true);
+    obs_data_set_default_string(settings, "ingest_cores", "");
+    obs_data_set_default_string(settings, "decode_cores", "");
+    obs_data_set_default_string(settings, "audio_cores", "");
+    obs_data_set_default_int(settings, "iso", 0);
+    obs_data_set_default_int(settings, "exposure", 0);
+    obs_data_set_default_int(settings, "focus", -1);
+}
+
+// A subscriber forwards only the settings it changed since its last update, so its stale
+// copies of fields another subscriber has set never reach the shared device. Each helper
+// records the value in applied and reports whether it differs from the one recorded before.
+static bool int_setting_changed(obs_data_t *settings, obs_data_t *applied, const char *name) {
+    long long value = obs_data_get_int(settings, name);
+    bool changed = !obs_data_has_user_value(applied, name) || obs_data_get_int(applied, name) != value;
+    obs_data_set_int(applied, name, value);
+    return changed;
+}
+
+static bool bool_setting_changed(obs_data_t *settings, obs_data_t *applied, const char *name) {
+    bool value = obs_data_get_bool(settings, name);
+    bool changed = !obs_data_has_user_value(applied, name) || obs_data_get_bool(applied, name) != value;
+    obs_data_set_bool(applied, name, value);
+    return changed;
+}
+
+static bool string_setting_changed(obs_data_t *settings, obs_data_t *applied, const char *name) {
+    const char *value = obs_data_get_string(settings, name);
+    bool changed = !obs_data_has_user_value(applied, name) || strcmp(obs_data_get_string(applied, name), value) != 0;
+    obs_data_set_string(applied, name, value);
+    return changed;
+}
+
+// Camera settings belong to the phone, so the last subscriber to change one wins
+static void device_apply_settings(struct ocam_device *dev, obs_data_t *settings, obs_data_t *applied) {
+
+    const char *res_str = obs_data_get_string(settings, "resolution");
+    int w = 0, h = 0;
+    if (string_setting_changed(settings, applied, "resolution") && sscanf(res_str, "%dx%d", &w, &h) == 2) {
+        if (w != dev->current_w || h != dev->current_h) {
+            blog(LOG_INFO, "[OCAM] Setting Resolution: %dx%d", w, h);
+            send_control_command(dev, 0x01, w, h);
+            dev->current_w = w; dev->current_h = h;
+        }
+    }
+
+    int fps = (int)obs_data_get_int(settings, "fps");
+    if (int_setting_changed(settings, applied, "fps") && fps != dev->current_fps) {
+        blog(LOG_INFO, "[OCAM] Setting FPS: %d", fps);
+        send_control_command(dev, 0x02, fps, 0);
+        dev->current_fps = fps;
+    }
+
+    int bitrate_mbps = (int)obs_data_get_int(settings, "bitrate");
+    if (int_setting_changed(settings, applied, "bitrate") && bitrate_mbps != dev->current_bitrate) {
+        blog(LOG_INFO, "[OCAM] Setting Bitrate: %d Mbps", bitrate_mbps);
+        send_control_command(dev, 0x03, bitrate_mbps * 1000000, 0);
+        dev->current_bitrate = bitrate_mbps;
+    }
+
+    bool flash = obs_data_get_bool(settings, "flash");
+    if (bool_setting_changed(settings, applied, "flash") && flash != dev->current_flash) {
+        send_control_command(dev, 0x09, flash ? 1 : 0, 0);
+        dev->current_flash = flash;
+    }
+
+    int iso = (int)obs_data_get_int(settings, "iso");
+    if (int_setting_changed(settings, applied, "iso") && iso != dev->current_iso) {
+        send_control_command(dev, 0x06, iso, 0);
+        dev->current_iso = iso;
+    }
+
+    int exp = (int)obs_data_get_int(settings, "exposure");
+    if (int_setting_changed(settings, applied, "exposure") && exp != dev->current_exp) {
+        send_control_command(dev, 0x07, exp, 0);
+        dev->current_exp = exp;
+    }
+
+    int focus = (int)obs_data_get_int(settings, "focus");
+    if (int_setting_changed(settings, applied, "focus") && focus != dev->current_focus) {
+        send_control_command(dev, 0x08, focus, 0);
+        dev->current_focus = focus;
+    }
+
+    bool chunked = obs_data_get_bool(settings, "chunked_decode");
+    if (bool_setting_changed(settings, applied, "chunked_decode") && chunked != dev->chunked_decode) {
+        blog(LOG_INFO, "[OCAM] Slice Decoding: %s", chunked ? "on" : "off");
+        dev->chunked_decode = chunked;
+    }
+
+    int jitter_window = (int)obs_data_get_int(settings, "jitter_window");
+    if (int_setting_changed(settings, applied, "jitter_window") && jitter_window != dev->jitter_window_ms) {
+        blog(LOG_INFO, "[OCAM] Jitter Window: %d ms", jitter_window);
+        dev->jitter_window_ms = jitter_window;
+        // Off takes effect right away; other values at the next cadence window
+        if (jitter_window == 0) {
+            pacer_retune(&dev->pacer, 0);
+            apply_async_mode(dev, true, 0);
+        }
+    }
+
+    const char *backend = obs_data_get_string(settings, "decoder_backend");
+    pthread_mutex_lock(&dev->mutex);
+    bool backend_changed = string_setting_changed(settings, applied, "decoder_backend") && strcmp(backend, dev->backend_name) != 0;
+    if (backend_changed) {
+        snprintf(dev->backend_name, sizeof(dev->backend_name), "%s", backend);
+        dev->backend_rejected = NULL;
+    }
+    pthread_mutex_unlock(&dev->mutex);
+    if (backend_changed) {
+        blog(LOG_INFO, "[OCAM] Decoder: %s", *backend ? backend : "auto");
+        os_atomic_inc_long(&backend_cache.generation);
+    }
+}
+
+// A source joining a phone another source has already set up takes the phone's current settings
+// instead of pushing its own, which may be stale
+static void device_fill_settings(struct ocam_device *dev, obs_data_t *settings) {
+    if (dev->current_w <= 0) return;
+
+    struct dstr res = {0};
+    dstr_printf(&res, "%dx%d", dev->current_w, dev->current_h);
+    obs_data_set_string(settings, "resolution", res.array);
+    dstr_free(&res);
+    obs_data_set_int(settings, "fps", dev->current_fps);
+    obs_data_set_int(settings, "bitrate", dev->current_bitrate);
+    obs_data_set_bool(settings, "flash", dev->current_flash);
+    obs_data_set_int(settings, "iso", dev->current_iso);
+    obs_data_set_int(settings, "exposure", dev->current_exp);
+    obs_data_set_int(settings, "focus", dev->current_focus);
+    obs_data_set_bool(settings, "chunked_decode", dev->chunked_decode);
+    obs_data_set_string(settings, "decoder_backend", dev->backend_name);
+    obs_data_set_int(settings, "jitter_window", dev->jitter_window_ms);
+}
+
+// --- Devices & Subscribers ---
+
+static void device_destroy(struct ocam_device *dev) {
+    dev->thread_running = false;
+
+    pthread_mutex_lock(&dev->mutex);
+    if (dev->video_client_fd != -1) { shutdown(dev->video_client_fd, SHUTDOWN_FLAGS); CLOSESOCKET(dev->video_client_fd); dev->video_client_fd = -1; }
+    if (dev->control_client_fd != -1) { shutdown(dev->control_client_fd, SHUTDOWN_FLAGS); CLOSESOCKET(dev->control_client_fd); dev->control_client_fd = -1; }
+    if (dev->audio_client_fd != -1) { shutdown(dev->audio_client_fd, SHUTDOWN_FLAGS); CLOSESOCKET(dev->audio_client_fd); dev->audio_client_fd = -1; }
+    
+    if (dev->video_server_fd != -1) { shutdown(dev->video_server_fd, SHUTDOWN_FLAGS); CLOSESOCKET(dev->video_server_fd); dev->video_server_fd = -1; }
+    if (dev->control_server_fd != -1) { shutdown(dev->control_server_fd, SHUTDOWN_FLAGS); CLOSESOCKET(dev->control_server_fd); dev->control_server_fd = -1; }
+    if (dev->audio_server_fd != -1) { shutdown(dev->audio_server_fd, SHUTDOWN_FLAGS); CLOSESOCKET(dev->audio_server_fd); dev->audio_server_fd = -1; }
+    pthread_mutex_unlock(&dev->mutex);
+
+    if (dev->network_thread_active) pthread_join(dev->network_thread, NULL);
+    if (dev->control_thread_active) pthread_join(dev->control_thread, NULL);
+    if (dev->audio_thread_active) pthread_join(dev->audio_thread, NULL);
+
+    if (dev->video_queue_active) decode_queue_destroy(&dev->video_queue);
+
+    if (dev->pacer_thread_active) {
+        pthread_mutex_lock(&dev->pacer.mutex);
+        pthread_cond_broadcast(&dev->pacer.cond);
+        pthread_mutex_unlock(&dev->pacer.mutex);
+        pthread_join(dev->pacer_thread, NULL);
+    }
+    pacer_free(&dev->pacer);
+    av_frame_free(&dev->direct_frame);
+
+    if (dev->supported_resolutions) free(dev->supported_resolutions);
+    if (dev->supported_fps) free(dev->supported_fps);
+    pthread_mutex_destroy(&dev->mutex);
+    pthread_mutex_destroy(&dev->sub_mutex);
+    pthread_mutex_destroy(&dev->schedule_mutex);
+    cleanup_ffmpeg(dev);
+    cleanup_audio_ffmpeg(dev);
+    gop_cache_free(&dev->gop);
+    if (dev->replay_packet) av_packet_free(&dev->replay_packet);
+    av_frame_free(&dev->last_frame);
+    blog(LOG_INFO, "[OCAM] Device on port %d stopped.", dev->port);
+    bfree(dev);
+}
+
+static struct ocam_device *device_create(int port) {
+    struct ocam_device *dev = bzalloc(sizeof(struct ocam_device));
+    dev->port = port;
+    snprintf(dev->name, sizeof(dev->name), "port %d", port);
+    dev->thread_running = true;
+    dev->video_server_fd = -1; dev->video_client_fd = -1;
+    dev->control_server_fd = -1; dev->control_client_fd = -1;
+    dev->audio_server_fd = -1; dev->audio_client_fd = -1;
 
     // Init Cache
-    s->current_w = -1; s->current_h = -1;
-    s->current_fps = -1; s->current_bitrate = -1;
-    s->current_iso = -1; s->current_exp = -1; s->current_focus = -100;
+    dev->current_w = -1; dev->current_h = -1;
+    dev->current_fps = -1; dev->current_bitrate = -1;
+    dev->current_iso = -1; dev->current_exp = -1; dev->current_focus = -100;
+
+    pthread_mutex_init(&dev->mutex, NULL);
+    pthread_mutex_init(&dev->sub_mutex, NULL);
+    pthread_mutex_init(&dev->schedule_mutex, NULL);
+    dev->last_frame = av_frame_alloc();
+    dev->direct_frame = av_frame_alloc();
+    dev->jitter_window_ms = -1;
+    dev->async_unbuffered = true;
+    pacer_init(&dev->pacer);
+
+    decode_queue_init(&dev->video_queue, dev->name, process_video_job, dev);
+    dev->video_queue_active = true;
+
+    if (pthread_create(&dev->network_thread, NULL, network_thread_func, dev) == 0) dev->network_thread_active = true;
+    if (pthread_create(&dev->control_thread, NULL, control_thread_func, dev) == 0) dev->control_thread_active = true;
+    if (pthread_create(&dev->audio_thread, NULL, audio_thread_func, dev) == 0) dev->audio_thread_active = true;
+    if (pthread_create(&dev->pacer_thread, NULL, pacer_thread_func, dev) == 0) dev->pacer_thread_active = true;
+
+    blog(LOG_INFO, "[OCAM] Device on port %d started.", port);
+    return dev;
+}
+
+// Sources with the same port share one device
+// Each device listens on port..port+2, so a nearby port would collide with it.
+// Returns the overlapping device's port, or 0. A device only `leaving` holds does not count.
+static int device_port_conflict(int port, struct ocam_device *leaving) {
+    int conflict = 0;
+    pthread_mutex_lock(&device_registry.mutex);
+    for (struct ocam_device *dev = device_registry.head; dev && !conflict; dev = dev->next) {
+        if (dev->port == port || abs(dev->port - port) > AUDIO_PORT - VIDEO_PORT) continue;
+        if (dev == leaving && dev->refs == 1) continue;
+        conflict = dev->port;
+    }
+    pthread_mutex_unlock(&device_registry.mutex);
+    return conflict;
+}
 
-    pthread_mutex_init(&s->mutex, NULL);
+static struct ocam_device *device_acquire(int port) {
+    pthread_mutex_lock(&device_registry.mutex);
+    struct ocam_device *dev = device_registry.head;
+    while (dev && dev->port != port) dev = dev->next;
+    if (!dev) {
+        dev = device_create(port);
+        dev->next = device_registry.head;
+        device_registry.head = dev;
+    }
+    dev->refs++;
+    pthread_mutex_unlock(&device_registry.mutex);
+    return dev;
+}
 
-    if (pthread_create(&s->network_thread, NULL, network_thread_func, s) == 0) s->network_thread_active = true;
-    if (pthread_create(&s->control_thread, NULL, control_thread_func, s) == 0) s->control_thread_active = true;
-    if (pthread_create(&s->audio_thread, NULL, audio_thread_func, s) == 0) s->audio_thread_active = true;
+static void device_release(struct ocam_device *dev) {
+    bool last = false;
+    pthread_mutex_lock(&device_registry.mutex);
+    if (--dev->refs == 0) {
+        struct ocam_device **p = &device_registry.head;
+        while (*p != dev) p = &(*p)->next;
+        *p = dev->next;
+        last = true;
+    }
+    pthread_mutex_unlock(&device_registry.mutex);
+    if (last) device_destroy(dev);
+}
+
+// Decode runs while any subscriber is visible, at the highest priority any of them asks for
+static void device_update_scheduling(struct ocam_device *dev) {
+    pthread_mutex_lock(&dev->schedule_mutex);
+
+    bool high = false, visible = false;
+    pthread_mutex_lock(&dev->sub_mutex);
+    for (struct ocam_source *sub = dev->subscribers; sub; sub = sub->next) {
+        high = high || sub->decode_priority == 1 || (sub->decode_priority == 0 && sub->program_active);
+        visible = visible || sub->showing || sub->program_active;
+    }
+    pthread_mutex_unlock(&dev->sub_mutex);
+
+    decode_queue_set_priority(&dev->video_queue, high ? DECODE_PRIORITY_HIGH : DECODE_PRIORITY_NORMAL);
+    if (visible != dev->decode_wanted) {
+        dev->decode_wanted = visible;
+        submit_video_job(dev, visible ? DECODE_JOB_RESUME : DECODE_JOB_PAUSE, NULL, 0, 0, 0, 0, 0);
+    }
+    pthread_mutex_unlock(&dev->schedule_mutex);
+}
 
-    ocam_update(s, settings);
-    return s;
+static void device_attach(struct ocam_device *dev, struct ocam_source *sub) {
+    pthread_mutex_lock(&dev->sub_mutex);
+    sub->next = dev->subscribers;
+    dev->subscribers = sub;
+    dev->subscriber_count++;
+    obs_source_set_async_unbuffered(sub->source, dev->async_unbuffered);
+    // A late joiner shows the current picture right away
+    deliver_last_frame(dev, sub);
+    pthread_mutex_unlock(&dev->sub_mutex);
+    device_update_scheduling(dev);
 }
 
+static void device_detach(struct ocam_device *dev, struct ocam_source *sub) {
+    pthread_mutex_lock(&dev->sub_mutex);
+    for (struct ocam_source **p = &dev->subscribers; *p; p = &(*p)->next) {
+        if (*p == sub) {
+            *p = sub->next;
+            dev->subscriber_count--;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&dev->sub_mutex);
+    device_update_scheduling(dev);
+}
+
+// --- Main Lifecycle ---
+
+static void ocam_subscribe(struct ocam_source *sub, int port) {
+    int conflict = device_port_conflict(port, sub->device);
+    if (conflict && conflict != sub->port_conflict)
+        blog(LOG_WARNING, "[OCAM] Port %d overlaps the source on port %d%s", port, conflict, sub->device ? "; keeping the current port" : "");
+    sub->requested_port = port;
+    sub->port_conflict = conflict;
+    // A running source keeps its device; a new one has to start somewhere and reports the bind failure
+    if (sub->device && (conflict || port == sub->port)) return;
+
+    if (sub->device) {
+        device_detach(sub->device, sub);
+        device_release(sub->device);
+    }
+    obs_data_release(sub->applied);
+    sub->applied = NULL;
+    sub->port = port;
+    sub->device = device_acquire(port);
+    device_attach(sub->device, sub);
+}
+
+static void ocam_update(void *data, obs_data_t *settings) {
+    struct ocam_source *sub = data;
+
+    int port = (int)obs_data_get_int(settings, "port");
+    if (port != sub->port || port != sub->requested_port) ocam_subscribe(sub, port);
+
+    struct ocam_device *dev = sub->device;
+    if (!sub->applied) {
+        device_fill_settings(dev, settings);
+        sub->applied = obs_data_create();
+    }
+    device_apply_settings(dev, settings, sub->applied);
+    thread_policy_update(settings);
+
+    pthread_mutex_lock(&dev->sub_mutex);
+    sub->decode_priority = (int)obs_data_get_int(settings, "decode_priority");
+    pthread_mutex_unlock(&dev->sub_mutex);
+    device_update_scheduling(dev);
+}
+
+static void ocam_destroy(void *data) {
+    struct ocam_source *sub = data;
+    device_detach(sub->device, sub);
+    device_release(sub->device);
+    obs_data_release(sub->applied);
+    bfree(sub);
+}
+
+static void *ocam_create(obs_data_t *settings, obs_source_t *source) {
+    struct ocam_source *sub = bzalloc(sizeof(struct ocam_source));
+    sub->source = source;
+
+    ocam_subscribe(sub, (int)obs_data_get_int(settings, "port"));
+    thread_policy_fill_settings(settings);
+    ocam_update(sub, settings);
+    return sub;
+}
+
+static void set_subscriber_state(struct ocam_source *sub, bool *state, bool value) {
+    pthread_mutex_lock(&sub->device->sub_mutex);
+    *state = value;
+    pthread_mutex_unlock(&sub->device->sub_mutex);
+    device_update_scheduling(sub->device);
+}
+
+static void ocam_activate(void *data) { struct ocam_source *sub = data; set_subscriber_state(sub, &sub->program_active, true); }
+static void ocam_deactivate(void *data) { struct ocam_source *sub = data; set_subscriber_state(sub, &sub->program_active, false); }
+static void ocam_show(void *data) { struct ocam_source *sub = data; set_subscriber_state(sub, &sub->showing, true); }
+static void ocam_hide(void *data) { struct ocam_source *sub = data; set_subscriber_state(sub, &sub->showing, false); }
+
 static const char *ocam_get_name(void *unused) { UNUSED_PARAMETER(unused); return "OCam Source"; }
-static uint32_t ocam_get_width(void *data) { struct ocam_source *s = data; return s->width ? s->width : 1280; }
-static uint32_t ocam_get_height(void *data) { struct ocam_source *s = data; return s->height ? s->height : 720; }
+static uint32_t ocam_get_width(void *data) { struct ocam_source *sub = data; return sub->width ? sub->width : 1280; }
+static uint32_t ocam_get_height(void *data) { struct ocam_source *sub = data; return sub->height ? sub->height : 720; }
 
 static struct obs_source_info ocam_source_info = {
     .id = "ocam_source",
@@ -800,10 +3534,28 @@ static struct obs_source_info ocam_source_info = {
     .update = ocam_update,
     .get_properties = ocam_get_properties,
     .get_defaults = ocam_get_defaults,
+    .activate = ocam_activate,
+    .deactivate = ocam_deactivate,
+    .show = ocam_show,
+    .hide = ocam_hide,
     .icon_type = OBS_ICON_TYPE_CAMERA,
 };
 
 OBS_DECLARE_MODULE()
 OBS_MODULE_USE_DEFAULT_LOCALE("obs-ocam-source", "en-US")
-bool obs_module_load(void) { obs_register_source(&ocam_source_info); return true; }
-void obs_module_unload(void) {}
+bool obs_module_load(void) {
+    pthread_mutex_init(&decode_pool.mutex, NULL);
+    pthread_mutex_init(&device_registry.mutex, NULL);
+    pthread_mutex_init(&backend_cache.mutex, NULL);
+    pthread_mutex_init(&thread_policy.mutex, NULL);
+    thread_policy_snapshot();
+    obs_register_source(&ocam_source_info);
+    return true;
+}
+void obs_module_unload(void) {
+    if (backend_cache.thread_active) pthread_join(backend_cache.thread, NULL);
+    pthread_mutex_destroy(&backend_cache.mutex);
+    pthread_mutex_destroy(&thread_policy.mutex);
+    pthread_mutex_destroy(&device_registry.mutex);
+    pthread_mutex_destroy(&decode_pool.mutex);
+}
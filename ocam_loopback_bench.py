@@ -0,0 +1,224 @@
+#!/usr/bin/env python3
+"""Loopback benchmark for the OCam OBS plugin.
+
+Plays an H.264 Annex B clip into a running OCam source exactly like the phone
+app does (video port 27183), at one or more fixed frame rates such as 120 and
+240 fps, and reports the achieved send rate and pacing jitter. The plugin logs
+the matching receive side every ~30 s in the OBS log, with late and dropped
+counting the pictures since the previous line:
+
+    [OCAM] Cadence 'port 27183': ingest ... fps (jitter ...), decoded ... fps (jitter ...),
+           presented ... fps (jitter ...), window ... ms, ... late, ... dropped
+    [OCAM] Decode 'port 27183': ... fps, queue delay avg ... / max ...
+
+Make a clip with ffmpeg, for example:
+
+    ffmpeg -f lavfi -i testsrc2=size=1280x720:rate=240 -t 10 -c:v libx264 \\
+           -profile:v baseline -g 240 -bf 0 -f h264 clip_240.h264
+
+Then, with OBS running and an OCam source added and visible in the current scene
+(a hidden source only caches the stream, so nothing is decoded or logged):
+
+    python ocam_loopback_bench.py clip_240.h264 --fps 120 240
+
+With --obs-log (a log file, or "auto" for the newest log in the default OBS log
+folder) the bench also reads the plugin's lines written during each run and
+reports ingest, decode and present rates next to the send side. It exits with
+status 1 when a stage falls below --min-ratio of the target rate or its jitter
+exceeds --max-jitter-ms. A line only comes every ~30 s, so the default run of
+65 s gets at least two; shorter runs may get none.
+"""
+import argparse
+import glob
+import os
+import re
+import socket
+import struct
+import sys
+import time
+
+VIDEO_PORT = 27183
+NAME_BUFFER_SIZE = 64
+
+CADENCE_RE = re.compile(
+    r"\[OCAM\] Cadence '(?P<name>[^']*)': "
+    r"ingest (?P<ingest_fps>[\d.]+) fps \(jitter (?P<ingest_jitter>[\d.]+) ms, max gap (?P<ingest_gap>[\d.]+) ms\), "
+    r"decoded (?P<decoded_fps>[\d.]+) fps \(jitter (?P<decoded_jitter>[\d.]+) ms, max gap (?P<decoded_gap>[\d.]+) ms\), "
+    r"presented (?P<presented_fps>[\d.]+) fps \(jitter (?P<presented_jitter>[\d.]+) ms, max gap (?P<presented_gap>[\d.]+) ms\), "
+    r"window (?P<window>[\d.]+) ms, (?P<late>\d+) late, (?P<dropped>\d+) dropped")
+DECODE_RE = re.compile(
+    r"\[OCAM\] Decode '(?P<name>[^']*)': (?P<fps>[\d.]+) fps, queue delay avg (?P<delay_avg>[\d.]+) ms / "
+    r"max (?P<delay_max>[\d.]+) ms, depth max (?P<depth>\d+), worker busy (?P<busy>[\d.]+)%")
+
+
+def split_nals(data):
+    """Return the NAL units of an Annex B stream, each with its start code."""
+    starts = []
+    i = 0
+    while True:
+        i = data.find(b"\x00\x00\x01", i)
+        if i < 0:
+            break
+        starts.append(i - 1 if i > 0 and data[i - 1] == 0 else i)
+        i += 3
+    return [data[s:e] for s, e in zip(starts, starts[1:] + [len(data)])]
+
+
+def nal_type(nal):
+    i = nal.index(b"\x00\x00\x01") + 3
+    return nal[i] & 0x1F, nal[i + 1] if i + 1 < len(nal) else 0
+
+
+def split_access_units(data):
+    """Group NAL units into (config, [access units]) like MediaCodec output."""
+    config = b""
+    units = []
+    current = b""
+    has_slice = False
+    for nal in split_nals(data):
+        ntype, first_byte = nal_type(nal)
+        is_slice = 1 <= ntype <= 5
+        # first_mb_in_slice == 0 (ue(v) '1') starts a new picture
+        starts_picture = is_slice and (first_byte & 0x80)
+        if has_slice and (ntype in (6, 7, 8, 9) or starts_picture):
+            units.append(current)
+            current, has_slice = b"", False
+        if not units and not has_slice and ntype in (7, 8):
+            config += nal
+            continue
+        current += nal
+        has_slice = has_slice or is_slice
+    if has_slice:
+        units.append(current)
+    return config, units
+
+
+def default_obs_log():
+    """Newest log in the default OBS Studio log folder, or None."""
+    if sys.platform == "win32":
+        folder = os.path.join(os.environ.get("APPDATA", ""), "obs-studio", "logs")
+    elif sys.platform == "darwin":
+        folder = os.path.expanduser("~/Library/Application Support/obs-studio/logs")
+    else:
+        folder = os.path.expanduser("~/.config/obs-studio/logs")
+    logs = glob.glob(os.path.join(folder, "*.txt"))
+    return max(logs, key=os.path.getmtime) if logs else None
+
+
+def read_log_from(path, offset):
+    with open(path, "rb") as f:
+        f.seek(offset)
+        return f.read().decode("utf-8", errors="replace")
+
+
+def report_receive_side(text, port, fps, min_ratio, max_jitter_ms):
+    """Print the plugin's stage figures logged during a run; False if a stage missed the target."""
+    name = f"port {port}"
+    cadence = [m for m in CADENCE_RE.finditer(text) if m["name"] == name]
+    decode = [m for m in DECODE_RE.finditer(text) if m["name"] == name]
+    if not cadence:
+        print("  Receive side: no cadence lines in the OBS log (is the source visible? runs need over 30 s)")
+        return False
+
+    ok = True
+    for stage in ("ingest", "decoded", "presented"):
+        rates = [float(m[f"{stage}_fps"]) for m in cadence]
+        jitter = max(float(m[f"{stage}_jitter"]) for m in cadence)
+        gap = max(float(m[f"{stage}_gap"]) for m in cadence)
+        stage_ok = min(rates) >= fps * min_ratio and jitter <= max_jitter_ms
+        ok = ok and stage_ok
+        print(f"  {stage.capitalize():9} min {min(rates):.1f} fps, max jitter {jitter:.2f} ms, max gap {gap:.2f} ms"
+              f"{'' if stage_ok else '  <-- below target'}")
+    # Each line counts the pictures since the previous one
+    late = sum(int(m["late"]) for m in cadence)
+    dropped = sum(int(m["dropped"]) for m in cadence)
+    print(f"  Pacer     window {float(cadence[-1]['window']):.1f} ms, {late} late, {dropped} dropped")
+    if decode:
+        print(f"  Decoder   min {min(float(m['fps']) for m in decode):.1f} fps, "
+              f"queue delay max {max(float(m['delay_max']) for m in decode):.2f} ms, "
+              f"worker busy max {max(float(m['busy']) for m in decode):.1f}%")
+    return ok
+
+
+def run(args, fps, config, units):
+    sock = socket.create_connection((args.host, args.port))
+    sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    sock.sendall(b"OCam Loopback Bench".ljust(NAME_BUFFER_SIZE, b"\x00"))
+    sock.sendall(struct.pack(">III", 0x68323634, args.width, args.height))  # H264
+    sock.sendall(struct.pack(">QI", 0, len(config)) + config)
+
+    interval = 1.0 / fps
+    total = int(args.seconds * fps)
+    start = time.perf_counter()
+    last = start
+    intervals = []
+    sent_bytes = 0
+
+    for n in range(total):
+        # Pace on absolute deadlines so a late frame does not shift the rest
+        deadline = start + n * interval
+        while True:
+            remaining = deadline - time.perf_counter()
+            if remaining <= 0:
+                break
+            if remaining > 0.002:
+                time.sleep(remaining - 0.001)
+
+        unit = units[n % len(units)]
+        pts_us = int(n * interval * 1_000_000)  # Like the phone, the first picture has pts 0 too
+        sock.sendall(struct.pack(">QI", pts_us, len(unit)) + unit)
+        sent_bytes += len(unit)
+
+        now = time.perf_counter()
+        if n:
+            intervals.append(now - last)
+        last = now
+
+    elapsed = time.perf_counter() - start
+    sock.close()
+
+    mean = sum(intervals) / len(intervals)
+    jitter = sum(abs(b - a) for a, b in zip(intervals, intervals[1:])) / max(1, len(intervals) - 1)
+    print(f"{fps} fps: sent {total} frames in {elapsed:.2f} s: {total / elapsed:.1f} fps, "
+          f"{sent_bytes * 8 / elapsed / 1e6:.1f} Mbps")
+    print(f"  Send interval: mean {mean * 1e3:.3f} ms, jitter {jitter * 1e3:.3f} ms, max {max(intervals) * 1e3:.3f} ms")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Stream an H.264 clip into the OCam OBS plugin over loopback.")
+    parser.add_argument("clip", help="H.264 Annex B elementary stream")
+    parser.add_argument("--fps", type=int, nargs="+", default=[240], help="one run per rate, e.g. --fps 120 240")
+    parser.add_argument("--seconds", type=float, default=65.0, help="per rate; the plugin logs every ~30 s")
+    parser.add_argument("--obs-log", help='OBS log file to read the receive side from, or "auto"')
+    parser.add_argument("--min-ratio", type=float, default=0.97, help="lowest acceptable stage rate / target rate")
+    parser.add_argument("--max-jitter-ms", type=float, default=2.0, help="highest acceptable stage jitter")
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=VIDEO_PORT)
+    parser.add_argument("--width", type=int, default=1280)
+    parser.add_argument("--height", type=int, default=720)
+    args = parser.parse_args()
+
+    with open(args.clip, "rb") as f:
+        config, units = split_access_units(f.read())
+    if not config or not units:
+        raise SystemExit("Clip has no SPS/PPS or no pictures")
+    print(f"Loaded {len(units)} access units, config {len(config)} bytes")
+
+    log = default_obs_log() if args.obs_log == "auto" else args.obs_log
+    if args.obs_log and not log:
+        raise SystemExit("No OBS log found; pass the log file with --obs-log")
+
+    ok = True
+    for fps in args.fps:
+        offset = os.path.getsize(log) if log else 0
+        run(args, fps, config, units)
+        if log:
+            time.sleep(0.5)  # Let OBS flush the log
+            ok = report_receive_side(read_log_from(log, offset), args.port, fps, args.min_ratio, args.max_jitter_ms) and ok
+        time.sleep(1.0)  # The plugin resets its decoder between connections
+    if not ok:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()